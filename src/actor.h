@@ -32,6 +32,14 @@ Global size limits for actor and actor-like arrays.
 #define MAX_SHARDS              16
 #define MAX_SPAWNERS            6
 
+/*
+Actors that are asleep off-screen are indexed by the map column they're in, in
+buckets of 2^n columns covering the widest possible map.
+*/
+#define ACTOR_BUCKET_SHIFT      4
+#define ACTOR_BUCKETS           (2048 >> ACTOR_BUCKET_SHIFT)
+#define ACTOR_NOT_DORMANT       0xff
+
 /*
 Special constant used in the propagation of worm crate explosions.
 */
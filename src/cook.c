@@ -0,0 +1,290 @@
+/**
+ * Cosmore
+ * Copyright (c) 2020-2022 Scott Smitelli
+ *
+ * This source code is licensed under the MIT license found in the LICENSE file
+ * in the root directory of this source tree.
+ */
+
+/*****************************************************************************
+ *                         COSMORE ASSET COOK TOOL                           *
+ *                                                                           *
+ * This is a standalone program, not part of the game. It reads the status  *
+ * bar tiles, the solid map tiles, and every backdrop image out of an        *
+ * episode's STN/VOL group files, and writes them into a single "cooked"     *
+ * bundle file (COSMOx.CKD) with each image already split into EGA planes.   *
+ * Each backdrop is also stored with its three pre-scrolled variants. When   *
+ * the game finds a current bundle, it loads these assets with a few bulk    *
+ * copies instead of converting them byte-by-byte at run time.               *
+ *                                                                           *
+ * Usage: COOK COSMOx                                                        *
+ *****************************************************************************/
+
+#include <alloc.h>
+#include <io.h>
+#include <mem.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef unsigned char byte;
+typedef unsigned int  word;
+typedef unsigned long dword;
+
+#include "def.h"
+
+#define MAX_ENTRIES     GROUP_MAX_ENTRIES
+#define BACKDROP_SIZE   0x5a00U
+
+typedef struct {
+    char name[12];  /* not necessarily null-terminated */
+    char *filename;
+    dword offset;
+    dword length;
+} Entry;
+
+static char *backdropNames[] = BACKDROP_NAMES;
+static Entry entries[MAX_ENTRIES];
+static int numEntries = 0;
+static dword assetOffsets[NUM_COOKED_ASSETS];
+
+/*
+Read the header of one group file and append its entries to the directory.
+Returns the length of the group file in bytes, or zero if it can't be opened,
+and stores its modification timestamp (packed as in struct ftime, or zero)
+through `timestamp`.
+*/
+dword ReadGroupHeader(char *filename, dword *timestamp)
+{
+    byte header[GROUP_HEADER_SIZE];
+    FILE *fp = fopen(filename, "rb");
+    struct ftime stamp;
+    dword length;
+    int i;
+
+    *timestamp = 0;
+
+    if (fp == NULL) return 0;
+
+    memset(header, 0, GROUP_HEADER_SIZE);
+    fread(header, 1, GROUP_HEADER_SIZE, fp);
+    length = filelength(fileno(fp));
+    if (getftime(fileno(fp), &stamp) == 0) *timestamp = *(dword *)&stamp;
+    fclose(fp);
+
+    for (i = 0; i < GROUP_HEADER_SIZE; i += GROUP_ENTRY_SIZE) {
+        if (header[i] == '\0') break;
+
+        memcpy(entries[numEntries].name, header + i, 12);
+        entries[numEntries].filename = filename;
+        entries[numEntries].offset = *(dword *)(header + i + 12);
+        entries[numEntries].length = *(dword *)(header + i + 16);
+        numEntries++;
+    }
+
+    return length;
+}
+
+/*
+Find the named entry, using the same precedence as the game: STN entries before
+VOL entries, later entries in a header before earlier ones. Returns NULL if no
+group file contains the entry.
+*/
+Entry *FindEntry(char *entry_name)
+{
+    char name[13];
+    int i;
+
+    strncpy(name, entry_name, 12);
+    name[12] = '\0';
+    strupr(name);
+
+    for (i = numEntries - 1; i >= 0; i--) {
+        if (strncmp(entries[i].name, name, 11) == 0) return entries + i;
+    }
+
+    return NULL;
+}
+
+/*
+Read exactly `length` bytes of the named entry into `dest`, trying the group
+files first and then the current working directory. Returns 0 on success.
+*/
+int ReadEntry(char *entry_name, byte *dest, word length)
+{
+    Entry *entry = FindEntry(entry_name);
+    FILE *fp;
+    word got;
+
+    if (entry != NULL) {
+        fp = fopen(entry->filename, "rb");
+        if (fp != NULL) fseek(fp, entry->offset, SEEK_SET);
+    } else {
+        fp = fopen(entry_name, "rb");
+    }
+
+    if (fp == NULL) return -1;
+
+    got = fread(dest, 1, length, fp);
+    fclose(fp);
+
+    return got == length ? 0 : -1;
+}
+
+/*
+Split row-planar image data (four bytes, one per plane, for every 8-pixel line)
+into plane-major order: all of plane 0, then all of plane 1, and so on.
+*/
+void SplitPlanes(byte *src, byte *dest, word length)
+{
+    word planelen = length / 4;
+    word i, plane;
+
+    for (i = 0; i < planelen; i++) {
+        for (plane = 0; plane < 4; plane++) {
+            *(dest + (plane * planelen) + i) = *(src++);
+        }
+    }
+}
+
+/*
+Produce a copy of a row-planar backdrop image scrolled left by 4 pixels, with
+the pixels that fall off the left edge wrapping around to the right edge. This
+gives the same result as ShiftPixelsHorizontally() in the game.
+*/
+void ScrollBackdropLeft(byte *src, byte *dest)
+{
+    word row, line, col, plane, here, next;
+
+    for (row = 0; row < 18; row++) {
+        for (line = 0; line < 8; line++) {
+            for (col = 0; col < 40; col++) {
+                for (plane = 0; plane < 4; plane++) {
+                    here = (row * 1280) + (col * 32) + (line * 4) + plane;
+                    next = (row * 1280) + (((col + 1) % 40) * 32) + (line * 4) + plane;
+
+                    *(dest + here) = (*(src + here) << 4) | (*(src + next) >> 4);
+                }
+            }
+        }
+    }
+}
+
+/*
+Produce a copy of a row-planar backdrop image scrolled up by 4 pixels, with the
+pixel lines that fall off the top edge wrapping around to the bottom edge. This
+gives the same result as ShiftPixelsVertically() in the game.
+*/
+void ScrollBackdropUp(byte *src, byte *dest)
+{
+    word y, srcy, col;
+
+    for (y = 0; y < 18 * 8; y++) {
+        srcy = (y + 4) % (18 * 8);
+
+        for (col = 0; col < 40; col++) {
+            memcpy(
+                dest + ((y / 8) * 1280) + (col * 32) + ((y % 8) * 4),
+                src + ((srcy / 8) * 1280) + (col * 32) + ((srcy % 8) * 4),
+                4
+            );
+        }
+    }
+}
+
+/*
+Split the passed row-planar image into planes, append it to the bundle, and
+remember where it was written.
+*/
+void WriteAsset(FILE *fp, word asset, byte *src, byte *scratch, word length)
+{
+    SplitPlanes(src, scratch, length);
+
+    assetOffsets[asset] = ftell(fp);
+    fwrite(scratch, 1, length, fp);
+}
+
+void main(int argc, char *argv[])
+{
+    char stnname[80], volname[80], outname[80];
+    dword stnlength, vollength, stntime, voltime;
+    word version = COOKED_VERSION;
+    byte *image, *hscroll, *vscroll, *scratch;
+    FILE *fp;
+    int i;
+
+    if (argc != 2 || strlen(argv[1]) > 70) {
+        printf("Usage: COOK COSMOx\n");
+        exit(EXIT_FAILURE);
+    }
+
+    sprintf(stnname, "%s.STN", argv[1]);
+    sprintf(volname, "%s.VOL", argv[1]);
+    sprintf(outname, "%s.CKD", argv[1]);
+
+    /* VOL first, so that STN entries are found first by the backwards search */
+    vollength = ReadGroupHeader(volname, &voltime);
+    stnlength = ReadGroupHeader(stnname, &stntime);
+
+    image = malloc(64000U);
+    scratch = malloc(64000U);
+    hscroll = malloc(BACKDROP_SIZE);
+    vscroll = malloc(BACKDROP_SIZE);
+
+    if (image == NULL || scratch == NULL || hscroll == NULL || vscroll == NULL) {
+        printf("Not enough memory.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    fp = fopen(outname, "wb");
+    if (fp == NULL) {
+        printf("Can't create %s.\n", outname);
+        exit(EXIT_FAILURE);
+    }
+
+    /* Header and (for now) an empty asset table; the table is rewritten last */
+    fwrite(COOKED_MAGIC, 1, 4, fp);
+    fwrite(&version, 2, 1, fp);
+    fwrite(&stnlength, 4, 1, fp);
+    fwrite(&vollength, 4, 1, fp);
+    fwrite(&stntime, 4, 1, fp);
+    fwrite(&voltime, 4, 1, fp);
+    fwrite(assetOffsets, 4, NUM_COOKED_ASSETS, fp);
+
+    if (ReadEntry("STATUS.MNI", image, 7296) == 0) {
+        WriteAsset(fp, COOKED_STATUS, image, scratch, 7296);
+    }
+
+    if (ReadEntry("TILES.MNI", image, 64000U) == 0) {
+        WriteAsset(fp, COOKED_TILES, image, scratch, 64000U);
+    }
+
+    for (i = 0; i < NUM_BACKDROPS; i++) {
+        if (ReadEntry(backdropNames[i], image, BACKDROP_SIZE) != 0) continue;
+
+        ScrollBackdropLeft(image, hscroll);
+        WriteAsset(fp, COOKED_BACKDROP(i, BDVARIANT_BASE), image, scratch, BACKDROP_SIZE);
+        WriteAsset(fp, COOKED_BACKDROP(i, BDVARIANT_H), hscroll, scratch, BACKDROP_SIZE);
+
+        ScrollBackdropUp(image, vscroll);
+        WriteAsset(fp, COOKED_BACKDROP(i, BDVARIANT_V), vscroll, scratch, BACKDROP_SIZE);
+
+        ScrollBackdropUp(hscroll, vscroll);
+        WriteAsset(fp, COOKED_BACKDROP(i, BDVARIANT_HV), vscroll, scratch, BACKDROP_SIZE);
+    }
+
+    fseek(fp, COOKED_HEADER_SIZE, SEEK_SET);
+    fwrite(assetOffsets, 4, NUM_COOKED_ASSETS, fp);
+
+    if (ferror(fp)) {
+        fclose(fp);
+        remove(outname);
+        printf("Error writing %s.\n", outname);
+        exit(EXIT_FAILURE);
+    }
+
+    fclose(fp);
+
+    printf("Wrote %s.\n", outname);
+    exit(EXIT_SUCCESS);
+}
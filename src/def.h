@@ -23,6 +23,69 @@ Demo states. Indicates if a demo is being recorded, played back, or neither.
 #define DEMOSTATE_NONE          0
 #define DEMOSTATE_RECORD        1
 #define DEMOSTATE_PLAY          2
+#define DEMOSTATE_EXPLORE       3  /* StepGame() only; input from ReadExploreFrame() */
+
+/*
+Demo file format. The original format is a word frame count followed by one
+input byte per frame. Version 2 files begin with DEMO_MAGIC (whose first word
+is far larger than any original frame count), a version word, and a dword
+frame count. The input bytes follow, run-length encoded: a byte with the high
+bit clear is the input for one frame, and a byte with the high bit set repeats
+the previous input for another (low seven bits + 1) frames. Version 3 adds a
+checkpoint before every DEMO_CHECK_INTERVAL frames (except the first): a word
+checksum of the player and scroll positions, the random number step counter and
+the number of live actors at that point, placed where the next input byte would
+go.
+Runs are cut short at a checkpoint, so it always falls between bytes. Demo files
+are streamed through a buffer of DEMO_BUFFER_SIZE bytes in both directions.
+*/
+#define DEMO_MAGIC              "CDM\x1a"
+#define DEMO_VERSION_RLE        2
+#define DEMO_VERSION_CHECKED    3
+#define DEMO_VERSION            DEMO_VERSION_CHECKED
+#define DEMO_CHECK_INTERVAL     256
+#define DEMO_RUN_FLAG           0x80
+#define DEMO_MAX_RUN            128
+#define DEMO_BUFFER_SIZE        256
+
+/*
+Per-demo outcomes of VerifyDemos(), stored in place of the first divergent frame
+number.
+*/
+#define DEMO_NO_DIVERGENCE      0xffffffffUL
+#define DEMO_GOLDEN_WRITTEN     0xfffffffeUL
+#define DEMO_NOT_FOUND          0xfffffffdUL
+#define DEMO_GOLDEN_UNWRITABLE  0xfffffffcUL
+
+/*
+Demo keyframe files. A keyframe file belongs to one demo file and holds a copy
+of the world taken every DEMO_KEY_INTERVAL frames of playback, so any frame can
+be reached by restoring the keyframe before it and running the rest. It begins
+with a DemoKeyHeader. Each keyframe is a DemoKeyframe followed by the world in
+the same form as a mid-level save file, ended by a WORLD_STATE_END pair, with a
+CRC over both in the DemoKeyframe. A table of keyframe file offsets comes last.
+*/
+#define DEMO_KEY_MAGIC          "CDK\x1a"
+#define DEMO_KEY_VERSION        4
+#define DEMO_KEY_INTERVAL       500
+#define DEMO_KEY_MAX            1024
+
+/*
+Input explorer. Each search step tries every action in the explorer's action
+table, held for EXPLORE_HOLD frames, looking EXPLORE_DEPTH actions ahead. States
+already seen during a step are pruned using a hash set of EXPLORE_SET_SIZE
+entries (a power of two), keyed on two unrelated 16-bit checksums of the world.
+*/
+#define EXPLORE_HOLD            6
+#define EXPLORE_DEPTH           2
+#define EXPLORE_SET_SIZE        256
+
+/*
+Step server request commands. See ServeSteps().
+*/
+#define SERVE_RESET             'R'
+#define SERVE_STEP              'S'
+#define SERVE_QUIT              'Q'
 
 /*
 Two-way direction systems. For actors that only move in one dimension, these
@@ -86,6 +149,13 @@ quitting the game or restarting the game loop on a new level.
 #define GAME_INPUT_QUIT         1
 #define GAME_INPUT_RESTART      2
 
+/*
+Return states for a single frame of the game loop.
+*/
+#define GAME_STEP_CONTINUE      0
+#define GAME_STEP_QUIT          1
+#define GAME_STEP_WIN_GAME      2
+
 /*
 In-game menu return states. Same idea as GAME_INPUT_*, except the values don't
 match up.
@@ -94,6 +164,90 @@ match up.
 #define GAME_MENU_RESTART       1
 #define GAME_MENU_QUIT          2
 
+/*
+Group file identifiers and directory limits. Each STN/VOL header is 960 bytes
+long, made up of 20-byte entries. The hash table size must be a power of two
+larger than the combined number of entries in both headers.
+*/
+#define GROUP_STN               0
+#define GROUP_VOL               1
+#define GROUP_HEADER_SIZE       960
+#define GROUP_ENTRY_SIZE        20
+#define GROUP_MAX_ENTRIES       ((GROUP_HEADER_SIZE / GROUP_ENTRY_SIZE) * 2)
+#define GROUP_HASH_SIZE         128
+#define GROUP_HASH_EMPTY        BYTE_MAX
+
+/*
+Backdrop image group entry names, indexed by the backdrop number in map flags.
+Shared between the game and the asset cook tool.
+*/
+#define NUM_BACKDROPS           26
+#define BACKDROP_NAMES { \
+    "bdblank.mni", "bdpipe.MNI", "bdredsky.MNI", "bdrocktk.MNI", "bdjungle.MNI", \
+    "bdstar.MNI", "bdwierd.mni", "bdcave.mni", "bdice.mni", "bdshrum.mni", \
+    "bdtechms.mni", "bdnewsky.mni", "bdstar2.mni", "bdstar3.mni", \
+    "bdforest.mni", "bdmountn.mni", "bdguts.mni", "bdbrktec.mni", \
+    "bdclouds.mni", "bdfutcty.mni", "bdice2.mni", "bdcliff.mni", "bdspooky.mni", \
+    "bdcrystl.mni", "bdcircut.mni", "bdcircpc.mni" \
+}
+
+/*
+Cooked asset bundle layout, as written by COOK.EXE. The file starts with a
+22-byte header (4 magic bytes, version word, then the byte lengths of the STN
+and VOL group files the bundle was cooked from, then their DOS modification
+timestamps as packed by getftime()), followed by one dword file
+offset per asset (zero if the asset is absent). Each asset holds all of plane 0,
+then all of plane 1, and so on, ready to be copied straight into EGA memory.
+*/
+#define COOKED_MAGIC            "CKD\x1a"
+#define COOKED_VERSION          2
+#define COOKED_HEADER_SIZE      22
+#define COOKED_STATUS           0
+#define COOKED_TILES            1
+#define COOKED_BACKDROP(n, v)   (2 + ((n) * 4) + (v))
+#define NUM_COOKED_ASSETS       COOKED_BACKDROP(NUM_BACKDROPS, 0)
+
+/*
+Mid-level save file layout, as written by SaveWorldState(). A WorldSaveHeader is
+followed by a copy of the temporary save file as it was when the level began
+(SAVE_RECORD_SIZE bytes), the World struct exactly as it sits in memory, the
+palette step counter, and then one {cell, tile} word pair for each map cell that
+differs from the level's map file, up to the end of the file. The CRC covers all
+of that and the other header fields. The map comparison and the checksum pass
+work through the file in chunks of WORLD_SAVE_CHUNK bytes.
+*/
+#define SAVE_RECORD_SIZE        24  /* size of a file written by SaveGameState() */
+#define WORLD_SAVE_MAGIC        "CWS\x1a"
+#define WORLD_SAVE_VERSION      2
+#define WORLD_SAVE_CHUNK        4096
+#define CRC16_INITIAL           0xffff
+#define WORLD_STATE_END         0xffff  /* cell number that ends a list of map changes */
+
+/*
+Seed of the Turbo C rand() at program startup, and so the initial seed of
+WorldRand().
+*/
+#define RAND_SEED_INITIAL       1
+
+/*
+Backdrop variants. Each is the base image, scrolled left and/or up by 4 pixels.
+*/
+#define BDVARIANT_BASE          0
+#define BDVARIANT_H             1
+#define BDVARIANT_V             2
+#define BDVARIANT_HV            3
+
+/*
+Group entry prefetch limits. The buffer has room for one backdrop image plus one
+modestly sized music entry. Staging only happens early in each frame's idle
+wait, and never moves more than one chunk per step.
+*/
+#define PREFETCH_BUFFER_SIZE    (0x5a00U + 0x4000U)
+#define PREFETCH_HEADROOM       4096
+#define PREFETCH_SLOTS          3
+#define PREFETCH_CHUNK_SIZE     2048
+#define PREFETCH_TICK_LIMIT     8
+
 /*
 Joystick identifiers. This game doesn't use joystick B, but some functionality
 for it is present.
@@ -118,11 +272,13 @@ Pounce hint queueing state.
 
 /*
 "Restore game" menu return states. Differentiates between successful loads,
-failures, and user aborts.
+failures, and user aborts. A resumed game was restored from a mid-level save
+file and is already set up on its level.
 */
 #define RESTORE_GAME_NOT_FOUND  0
 #define RESTORE_GAME_SUCCESS    1
 #define RESTORE_GAME_ABORT      2
+#define RESTORE_GAME_RESUMED    3
 
 /*
 Size of the game window, not including the status bar and the one-tile black
@@ -130,3 +286,16 @@ border at the top/left/right edges of the screen.
 */
 #define SCROLLW                 38
 #define SCROLLH                 18
+
+/*
+Largest change in the scroll position, in tiles on either axis, that a video
+page can be brought up to date with by scrolling it in place. Past this, there
+is little left on the page worth keeping and the map is redrawn in full.
+*/
+#define SCROLL_DELTA_MAX        8
+
+/*
+Size of one collision plane: one bit for each of the 32,768 map cells, plus one
+spare word so a span test can always read the word following its first one.
+*/
+#define COLLISION_PLANE_SIZE    ((32768U / 8) + 2)
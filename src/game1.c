@@ -26,10 +26,8 @@
 Overarching game control variables.
 */
 bbool isInGame = false;
-bool winGame;
-dword gameScore, gameStars;
 static bbool isNewGame;
-static bool winLevel;
+static bbool isLevelResumed;
 
 /*
 Memory content indicators. Used to determine if the values currently held in
@@ -39,38 +37,24 @@ from a group entry.
 static bbool isCartoonDataLoaded = false;
 word miscDataContents = IMAGE_NONE;
 
-/*
-Player position and game interaction variables. Most of these are under direct
-or almost-direct control of the player.
-*/
-word playerHealth, playerMaxHealth, playerBombs;
-static word playerX, playerY, scrollX, scrollY;
-static word playerFaceDir, playerBombDir;
-static word playerBaseFrame = PLAYER_BASE_WEST;
-static word playerFrame = PLAYER_WALK_1;
-static word playerForceFrame;
-static byte playerClingDir;
-static bool canPlayerCling, isPlayerNearHintGlobe, isPlayerNearTransporter;
-
-/*
-Player one-shot variables. Each of these controls the "happens only once"
-behavior of something in the game. Some are reset when a new level is started,
-others persist for the whole game (and into save files).
-*/
-static bbool sawAutoHintGlobe;
-static bool sawJumpPadBubble, sawMonumentBubble, sawScooterBubble;
-static bool sawTransporterBubble, sawPipeBubble, sawBossBubble;
-static bool sawPusherRobotBubble, sawBearTrapBubble, sawMysteryWallBubble;
-static bool sawTulipLauncherBubble, sawHamburgerBubble, sawHurtBubble = false;
-static bool usedCheatCode, sawBombHint, sawHealthHint;
-static word pounceHintState;
-
 /*
 Debug mode and demo record/playback variables.
 */
 byte demoState;
-static word demoDataLength, demoDataPos;
+static FILE *demoFp;
+static dword demoFrameCount, demoFramePos;
+static dword demoBadCheckpoint = DEMO_NO_DIVERGENCE;  /* frame number, if any */
+static byte exploreInput;
+static bbool isExploreRecording, isExploreAborted;
+static FILE *demoKeyFp;
+static DemoKeyHeader demoKeyHeader;
+static dword *demoKeyIndex;
+static word demoVersion;
+static byte demoBuffer[DEMO_BUFFER_SIZE];
+static word demoBufferPos, demoBufferLength;
+static byte demoLastInput, demoRunLength;
 static bbool isDebugMode = false;
+bbool isHeadless = false;  /* simulate only; no drawing, no frame pacing */
 
 /*
 X any Y move component tables for DIR8_* directions.
@@ -84,16 +68,12 @@ elsewhere in the game.
 */
 word activePage = 0;
 word gameTickCount;
-static word randStepCount;
 static dword paletteStepCount;
 
 /*
-Player pain and death variables.
+Cheat toggles.
 */
 bool isGodMode = false;
-static bbool playerIsInvincible;
-static word playerHurtCooldown, playerDeadTime;
-static byte playerFallDeadTime = 0;
 
 /*
 String storage.
@@ -104,14 +84,7 @@ static char *fullscreenImageNames[] = {
     "PRETITLE.MNI", TITLE_SCREEN, "CREDIT.MNI", "BONUS.MNI", END_SCREEN,
     "ONEMOMNT.MNI"
 };
-static char *backdropNames[] = {
-    "bdblank.mni", "bdpipe.MNI", "bdredsky.MNI", "bdrocktk.MNI", "bdjungle.MNI",
-    "bdstar.MNI", "bdwierd.mni", "bdcave.mni", "bdice.mni", "bdshrum.mni",
-    "bdtechms.mni", "bdnewsky.mni", "bdstar2.mni", "bdstar3.mni",
-    "bdforest.mni", "bdmountn.mni", "bdguts.mni", "bdbrktec.mni",
-    "bdclouds.mni", "bdfutcty.mni", "bdice2.mni", "bdcliff.mni", "bdspooky.mni",
-    "bdcrystl.mni", "bdcircut.mni", "bdcircpc.mni"
-};
+static char *backdropNames[] = BACKDROP_NAMES;
 static char *mapNames[] = MAP_NAMES;
 char *musicNames[] = {
     "mcaves.mni", "mscarry.mni", "mboss.mni", "mrunaway.mni", "mcircus.mni",
@@ -127,30 +100,13 @@ static char *starBonusRanks[] = {
     "Rocket Scientist"
 };
 
-/*
-Player speed/movement variables. These control vertical movement in the form of
-jumping, pouncing, and falling. Horizontal movement takes the form of east/
-west sliding for slippery surfaces. There are also variables for involuntary
-pushes and "dizzy" immobilization.
-*/
-static word playerMomentumNorth = 0, playerMomentumSaved;
-static bool isPlayerLongJumping, isPlayerRecoiling = false;
-static bool isPlayerSlidingEast, isPlayerSlidingWest;
-static bbool isPlayerFalling;
-static int playerFallTime;
-#define playerJumpTime soundPriority[0]  /* HACK: `static byte playerJumpTime` would be sane */
-static word playerPushDir, playerPushMaxTime, playerPushTime, playerPushSpeed;
-static bbool canCancelPlayerPush;
-static bool isPlayerPushed, stopPlayerPushAtWall;
-static bool queuePlayerDizzy;
-static word playerDizzyLeft;
-
 /* ====================== STATIC DATA DEMARCATION LINE ====================== */
 
 /*
 System variables.
 */
 dword totalMemFreeBefore, totalMemFreeAfter;
+word backdropCacheHits, backdropCacheMisses;
 static InterruptFunction savedInt9;
 static char *writePath;
 
@@ -160,19 +116,15 @@ BSS storage areas. All of these are big ol' fixed-sized arrays.
 HighScoreName highScoreNames[11];
 dword highScoreValues[11];
 static byte soundPriority[80 + 1];
-static Platform platforms[MAX_PLATFORMS];
-static Fountain fountains[MAX_FOUNTAINS];
-static Light lights[MAX_LIGHTS];
-static Actor actors[MAX_ACTORS];
-static Shard shards[MAX_SHARDS];
-static word explosions[MAX_EXPLOSIONS][sizeof(Explosion) / sizeof(word)];  /* this one's weird */
-static Spawner spawners[MAX_SPAWNERS];
-static Decoration decorations[MAX_DECORATIONS];
-/* Holds each decoration's currently displayed frame. Why this isn't in the Decoration struct, who knows. */
-static word decorationFrame[MAX_DECORATIONS];
 static word backdropTable[2880];
 static char joinPathBuffer[80];
 
+/*
+The game world. Everything in here changes as the game is played and decides
+how it plays out; see the World struct in GLUE.H for the details.
+*/
+World world;
+
 /*
 Heap storage areas. Space for all of these is allocated on startup.
 */
@@ -180,25 +132,29 @@ byte *fontTileData, *maskedTileData, *miscData;
 static byte *actorTileData[3], *playerTileData, *tileAttributeData;
 static word *actorInfoData, *playerInfoData, *cartoonInfoData;
 static word *soundData1, *soundData2, *soundData3, *soundDataPtr[80];
-static union {byte *b; word *w;} mapData;
 
 /*
 Pass-by-global variables. If you see one of these in use, some earlier function
 wants to influence the behavior of a subsequently called function.
 */
 dword lastGroupEntryLength;
-static word nextActorIndex, nextDrawMode;
+static FILE *worldStateFp;
+
+/*
+Copy of the temporary save file that the current level restarts from. Snapshot
+restores only change this copy and flag the file as stale; the file is brought
+up to date before the game next reads it.
+*/
+static byte restartRecord[SAVE_RECORD_SIZE];
+static bbool isRestartStale;
 
 /*
-Keyboard and joystick variables. Also includes player immobilization and jump
-lockout flags.
+Keyboard and joystick variables.
 */
 byte lastScancode;
 bbool isKeyDown[BYTE_MAX];
 bool isJoystickReady;
 bbool cmdWest, cmdEast, cmdNorth, cmdSouth, cmdJump, cmdBomb;
-static bbool blockMovementCmds, cmdJumpLatch;
-static bool blockActionCmds;
 
 /*
 Customizable options. These are saved and persist across restarts.
@@ -214,44 +170,66 @@ static word activeSoundIndex, activeSoundPriority;
 static bool isNewSound, enableSpeaker;
 
 /*
-Level/map control and global world flags.
+Next-level prefetch control.
 */
-static word levelNum, mapFlags, musicNum;
-static word mapWidth, mapHeight, mapYPower;  /* y power = map width expressed as 2^n. */
-static bool hasLightSwitch, hasRain, hasHScrollBackdrop, hasVScrollBackdrop;
-static bool areForceFieldsActive, areLightsActive, arePlatformsActive;
-static byte paletteAnimationNum;
+static word prefetchLevelNum = WORD_MAX;
+static bool isPrefetchFlagsKnown;
 
 /*
-Actor (and similar) counts, as well as a few odds and ends for actors that
-interact heavily with the outside world.
+Map region redraw tracking, one set per video page. Each page remembers the
+scroll position it was last drawn at (WORD_MAX means "redraw everything") and
+has one bit per map region cell that must be redrawn because the map tile there
+changed or something was drawn over it.
 */
-word numActors;
-static word numPlatforms, numFountains, numLights;
-static word numBarrels, numEyePlants, pounceStreak;
-static word mysteryWallTime;
-static word activeTransporter, transporterTimeLeft;
-static word scooterMounted;  /* Acts like bool, except at moment of mount (decrements 4->1) */
-static bool isPounceReady;
-static bbool isPlayerInPipe;
+static word pageScrollX[2] = {WORD_MAX, WORD_MAX}, pageScrollY[2];
+static byte dirtyCells[2][SCROLLH][(SCROLLW + 7) / 8];
+
+/*
+Widest actor sprite frame, in tiles. Worked out once the sprites are loaded.
+*/
+static word maxSpriteWidth;
 
 /*
 Inline functions.
 */
 #define MAP_CELL_ADDR(x, y)   (mapData.w + ((y) << mapYPower) + x)
+#define MAP_ATTR_ADDR(x, y)   (mapAttributeData + ((y) << mapYPower) + x)
+#define ROW_BIT(x, y)         (((y) << mapYPower) + (x))
+#define COLUMN_BIT(x, y)      (((x) << (15 - mapYPower)) + (y))
 #define SET_PLAYER_DIZZY()    { queuePlayerDizzy = true; }
-#define TILE_BLOCK_SOUTH(val) (*(tileAttributeData + ((val) / 8)) & 0x01)
-#define TILE_BLOCK_NORTH(val) (*(tileAttributeData + ((val) / 8)) & 0x02)
-#define TILE_BLOCK_WEST(val)  (*(tileAttributeData + ((val) / 8)) & 0x04)
-#define TILE_BLOCK_EAST(val)  (*(tileAttributeData + ((val) / 8)) & 0x08)
-#define TILE_SLIPPERY(val)    (*(tileAttributeData + ((val) / 8)) & 0x10)
-#define TILE_IN_FRONT(val)    (*(tileAttributeData + ((val) / 8)) & 0x20)
-#define TILE_SLOPED(val)      (*(tileAttributeData + ((val) / 8)) & 0x40)
-#define TILE_CAN_CLING(val)   (*(tileAttributeData + ((val) / 8)) & 0x80)
+#define WORLD_RANDOM(num)     (WorldRand() % (num))  /* as random() in Turbo C */
+#define TILE_ATTR(val)        (*(tileAttributeData + ((val) / 8)))
+#define TILE_BLOCK_SOUTH(val) (TILE_ATTR(val) & TILEATTR_BLOCK_SOUTH)
+#define TILE_BLOCK_NORTH(val) (TILE_ATTR(val) & TILEATTR_BLOCK_NORTH)
+#define TILE_BLOCK_WEST(val)  (TILE_ATTR(val) & TILEATTR_BLOCK_WEST)
+#define TILE_BLOCK_EAST(val)  (TILE_ATTR(val) & TILEATTR_BLOCK_EAST)
+#define TILE_SLIPPERY(val)    (TILE_ATTR(val) & TILEATTR_SLIPPERY)
+#define TILE_IN_FRONT(val)    (TILE_ATTR(val) & TILEATTR_IN_FRONT)
+#define TILE_SLOPED(val)      (TILE_ATTR(val) & TILEATTR_SLOPED)
+#define TILE_CAN_CLING(val)   (TILE_ATTR(val) & TILEATTR_CAN_CLING)
+
+/* Descriptor for one frame of an actor sprite; see BuildSpriteFrames() */
+#define SPRITE_FRAME(sprite, frame) \
+    ((SpriteFrame *)(actorInfoData + *(actorInfoData + (sprite))) + (frame))
+
+/* Every actor death must go through here to keep the deadActors set in sync */
+#define KILL_ACTOR(act) { \
+    word killed = (act) - actors; \
+    (act)->dead = true; \
+    deadActors[killed >> 3] |= 1 << (killed & 7); \
+}
+
+/* x/y are screen tile coordinates, as passed to the low-level draw functions */
+#define MARK_SCREEN_TILE(x, y) { \
+    if ((word)((x) - 1) < SCROLLW && (word)((y) - 1) < SCROLLH) { \
+        dirtyCells[!activePage][(y) - 1][((x) - 1) >> 3] |= 1 << (((x) - 1) & 7); \
+    } \
+}
 
 /*
 Prototypes for "private" functions where strictly required.
 */
+void CopyPlanesToEGA(byte *, word, word);
 void DrawSprite(word, word, word, word, word);
 void DrawPlayer(byte, word, word, word);
 void DrawCartoon(byte, word, word);
@@ -272,6 +250,7 @@ char *JoinPath(char *, char *);
 bbool LoadGameState(char);
 byte ProcessGameInput(byte);
 void SwitchLevel(word);
+void ResetWorld(void);
 void InitializeGame(void);
 
 /*
@@ -279,7 +258,14 @@ Get the file size of the named group entry, in bytes.
 */
 dword GroupEntryLength(char *entry_name)
 {
-    fclose(GroupEntryFp(entry_name));
+    GroupEntry *entry = FindGroupEntry(entry_name);
+
+    if (entry == NULL) {
+        /* Not in a group file; only the file system knows how big this is */
+        fclose(GroupEntryFp(entry_name));
+    } else {
+        lastGroupEntryLength = entry->length;
+    }
 
     return lastGroupEntryLength;
 }
@@ -296,8 +282,8 @@ void ClearPlayerDizzy(void)
 /*
 Random number generator for world events.
 
-Unlike rand() or the random() macro, this function returns deterministic results
-for consistent demo recording/playback.
+Unlike WorldRand() or the WORLD_RANDOM() macro, this function doesn't hold any
+state of its own beyond a step counter.
 
 The upper bound for return value is on the order of 4,000.
 */
@@ -315,6 +301,19 @@ word GameRand(void)
     return randtable[randStepCount] + scrollX + scrollY + randStepCount + playerX + playerY;
 }
 
+/*
+Random number generator for effects and some actor behavior. This is the same
+generator as rand() in the Turbo C library, returning the same sequence, but it
+keeps its seed in the world so snapshots and saves capture it along with the
+rest of the game.
+*/
+int WorldRand(void)
+{
+    randSeed = (randSeed * 22695477L) + 1;
+
+    return (int)(randSeed >> 16) & 0x7fff;
+}
+
 /*
 Read the next color from the palette animation array and load it in.
 */
@@ -336,7 +335,6 @@ Handle palette animation for this frame.
 */
 void AnimatePalette(void)
 {
-    static byte lightningState = 0;
 
 #ifdef EXPLOSION_PALETTE
     if (paletteAnimationNum == PALANIM_EXPLOSIONS) return;
@@ -350,7 +348,7 @@ void AnimatePalette(void)
         } else if (lightningState == 1) {
             lightningState = 2;
             SetPaletteRegister(PALETTE_KEY_INDEX, MODE1_LIGHTGRAY);
-        } else if (rand() < 1500) {
+        } else if (WorldRand() < 1500) {
             SetPaletteRegister(PALETTE_KEY_INDEX, MODE1_WHITE);
             StartSound(SND_THUNDER);
             lightningState = 1;
@@ -497,6 +495,8 @@ void DrawTextLine(word x_origin, word y_origin, char *text)
             }
         }
 
+        MARK_SCREEN_TILE(x_origin + x, y_origin);
+
         if (text[x] >= 'a') {  /* lowercase */
             DrawSpriteTile(
                 /* `FONT_LOWER_A` is equal to ASCII 'a' */
@@ -522,10 +522,11 @@ rest of the game expects, so negate those bits while loading.
 void LoadFontTileData(char *entry_name, byte *dest, word length)
 {
     int i;
-    FILE *fp = GroupEntryFp(entry_name);
+    GroupView view;
 
-    fread(dest, length, 1, fp);
-    fclose(fp);
+    GroupEntryView(entry_name, &view);
+    ReadGroupView(&view, dest, length);
+    CloseGroupView(&view);
 
     /* Ideally should be `length`, not a literal 4000. */
     for (i = 0; i < 4000; i += 5) {
@@ -538,41 +539,29 @@ Replace the entire screen contents with a full-size (320x200) image.
 */
 void DrawFullscreenImage(word image_num)
 {
-    byte *destbase = MK_FP(0xa000, 0);
-
     if (image_num != IMAGE_TITLE && image_num != IMAGE_CREDITS) {
         StopMusic();
     }
 
     if (image_num != miscDataContents) {
-        FILE *fp = GroupEntryFp(fullscreenImageNames[image_num]);
+        GroupView view;
+
+        GroupEntryView(fullscreenImageNames[image_num], &view);
 
         miscDataContents = image_num;
 
-        fread(miscData, 32000, 1, fp);
-        fclose(fp);
+        ReadGroupView(&view, miscData, 32000);
+        CloseGroupView(&view);
     }
 
     EGA_MODE_DEFAULT();
     EGA_BIT_MASK_DEFAULT();
     FadeOut();
     SelectDrawPage(0);
+    InvalidateMapRegion();
 
-    {  /* for scope */
-        register word srcbase;
-        register int i;
-        word mask = 0x0100;
-
-        for (srcbase = 0; srcbase < 32000; srcbase += 8000) {
-            outport(0x03c4, 0x0002 | mask);
-
-            for (i = 0; i < 8000; i++) {
-                *(destbase + i) = *(miscData + i + srcbase);
-            }
-
-            mask <<= 1;
-        }
-    }
+    /* Fullscreen image data is already plane-major, 8,000 bytes per plane */
+    CopyPlanesToEGA(miscData, 8000, 0);
 
     SelectActivePage(0);
     FadeIn();
@@ -587,10 +576,11 @@ into a single linear pointer array.
 void LoadSoundData(char *entry_name, word *dest, int skip)
 {
     int i;
-    FILE *fp = GroupEntryFp(entry_name);
+    GroupView view;
 
-    fread(dest, (word)GroupEntryLength(entry_name), 1, fp);
-    fclose(fp);
+    GroupEntryView(entry_name, &view);
+    ReadGroupView(&view, dest, (word)view.length);
+    CloseGroupView(&view);
 
     for (i = 0; i < 23; i++) {
         soundDataPtr[i + skip] = dest + (*(dest + (i * 8) + 8) >> 1);
@@ -619,10 +609,11 @@ Read a group entry into system memory.
 */
 void LoadGroupEntryData(char *entry_name, byte *dest, word length)
 {
-    FILE *fp = GroupEntryFp(entry_name);
+    GroupView view;
 
-    fread(dest, length, 1, fp);
-    fclose(fp);
+    GroupEntryView(entry_name, &view);
+    ReadGroupView(&view, dest, length);
+    CloseGroupView(&view);
 }
 
 /*
@@ -630,13 +621,14 @@ Load actor tile data into system memory.
 */
 void LoadActorTileData(char *entry_name)
 {
-    FILE *fp = GroupEntryFp(entry_name);
+    GroupView view;
 
-    fread(actorTileData[0], WORD_MAX, 1, fp);
-    fread(actorTileData[1], WORD_MAX, 1, fp);
-    /* CAREFUL: Wraparound. Also, "ACTORS.MNI" should ideally use entry_name. */
-    fread(actorTileData[2], (word)GroupEntryLength("ACTORS.MNI") + 2, 1, fp);
-    fclose(fp);
+    GroupEntryView(entry_name, &view);
+    ReadGroupView(&view, actorTileData[0], WORD_MAX);
+    ReadGroupView(&view, actorTileData[1], WORD_MAX);
+    /* CAREFUL: Wraparound. */
+    ReadGroupView(&view, actorTileData[2], (word)view.length + 2);
+    CloseGroupView(&view);
 }
 
 /*
@@ -647,17 +639,33 @@ void CopyTilesToEGA(byte *source, word dest_length, word dest_offset)
     word i;
     word mask;
     byte *src = source;
-    byte *dest = MK_FP(0xa000, dest_offset);
 
     for (i = 0; i < dest_length; i++) {
         for (mask = 0x0100; mask < 0x1000; mask = mask << 1) {
-            outport(0x03c4, mask | 0x0002);
+            EGA_OUTPORT(0x03c4, mask | 0x0002);
 
-            *(dest + i) = *(src++);
+            EGA_POKE(dest_offset + i, *(src++));
         }
     }
 }
 
+/*
+Load plane-major image data into EGA memory. The source holds `plane_length`
+bytes for plane 0, followed by the same amount for planes 1, 2, and 3. This only
+needs to touch the map mask register once per plane.
+*/
+void CopyPlanesToEGA(byte *source, word plane_length, word dest_offset)
+{
+    word mask;
+
+    for (mask = 0x0100; mask < 0x1000; mask = mask << 1) {
+        EGA_OUTPORT(0x03c4, mask | 0x0002);
+
+        EGA_MOVMEM(source, dest_offset, plane_length);
+        source += plane_length;
+    }
+}
+
 /*
 Read a group entry containing "info" data into system memory.
 
@@ -668,18 +676,188 @@ that here `dest` is a word pointer.
 */
 void LoadInfoData(char *entry_name, word *dest, word length)
 {
-    FILE *fp = GroupEntryFp(entry_name);
+    GroupView view;
 
-    fread(dest, length, 1, fp);
-    fclose(fp);
+    GroupEntryView(entry_name, &view);
+    ReadGroupView(&view, dest, length);
+    CloseGroupView(&view);
+}
+
+/*
+Convert the frame records in the actor info data, in place, into SpriteFrame
+descriptors that the SPRITE_FRAME() macro can hand out directly.
+
+The info data starts with a table holding one word for each sprite type. This
+is the word offset (from the start of the info data) of that sprite's first
+frame record. The frame records follow, four words each: height and width in
+tiles, then the offset and the actorTileData chunk number of the frame's first
+tile. A SpriteFrame is the same size as one of these records, so the table can
+stay where it is and only the records need to be rewritten. The tile offset and
+chunk number are resolved into a pointer once here, instead of every time the
+frame is looked at.
+*/
+void BuildSpriteFrames(word length)
+{
+    word first = WORD_MAX;
+    word i;
+    word *record;
+    SpriteFrame *info;
+
+    /* Table ends where the lowest-addressed frame record begins */
+    for (i = 0; i < first; i++) {
+        if (*(actorInfoData + i) != 0 && *(actorInfoData + i) < first) {
+            first = *(actorInfoData + i);
+        }
+    }
+
+    for (i = first; i + 4 <= length / 2; i += 4) {
+        record = actorInfoData + i;
+        info = (SpriteFrame *)record;
+
+        info->tiles = actorTileData[*(record + 3)] + *(record + 2);
+        /* height and width are already in the right place */
+
+        if (info->width > maxSpriteWidth) maxSpriteWidth = info->width;
+    }
+}
+
+/*
+Draw the map region cell at screen tile xtile,ytile (zero-based, not counting
+the screen border) for the current scroll position. `bdbase` and `ybd` are the
+backdrop parameters DrawMapRegion() computed for this scroll position.
+*/
+void DrawMapCell(word xtile, word ytile, word bdbase, word ybd)
+{
+    word *mapcell = MAP_CELL_ADDR(scrollX + xtile, scrollY + ytile);
+    word bdcell = *(backdropTable + ybd + (ytile * 80) + xtile) + bdbase;
+    word destoff = xtile + 321 + (ytile * 320);
+
+    if (*mapcell < TILE_STRIPED_PLATFORM) {
+        DrawSolidTile(bdcell, destoff);
+    } else if (*mapcell >= TILE_MASKED_0) {
+        DrawSolidTile(bdcell, destoff);
+        DrawMaskedTile(maskedTileData + *mapcell, xtile + 1, ytile + 1);
+    } else {
+        DrawSolidTile(*mapcell, destoff);
+    }
+}
+
+/*
+Redraw only the map region cells that have been marked dirty on `page` since it
+was last drawn, then clear its dirty set. The scroll position must be the same
+as it was then.
+*/
+void DrawDirtyMapCells(word page, word bdbase, word ybd)
+{
+    word xtile, ytile;
+    byte *dirty;
+
+    for (ytile = 0; ytile < SCROLLH; ytile++) {
+        dirty = dirtyCells[page][ytile];
+
+        for (xtile = 0; xtile < SCROLLW; xtile++) {
+            if ((xtile & 7) == 0 && *(dirty + (xtile >> 3)) == 0) {
+                xtile += 7;  /* nothing in this group of eight */
+                continue;
+            }
+
+            if (*(dirty + (xtile >> 3)) & (1 << (xtile & 7))) {
+                DrawMapCell(xtile, ytile, bdbase, ybd);
+            }
+        }
+
+        memset(dirty, 0, (SCROLLW + 7) / 8);
+    }
+}
+
+/*
+Bring the map region on `page` from the scroll position it was last drawn at to
+the current one, where the two differ by dx,dy tiles. Solid map tiles that were
+already visible and haven't been disturbed since are moved to their new screen
+position inside video memory, in runs. Everything else is redrawn.
+
+Only solid tiles move along with the map. Backdrop cells (and masked tiles,
+which have backdrop showing through) either stay in place on the screen or, in
+parallax levels, move at half speed, so they always need to be redrawn.
+
+Cells are visited in the same direction the picture moves, which guarantees
+that no cell is overwritten before it has been copied to its new position.
+*/
+void ScrollMapRegion(word page, word bdbase, word ybd, int dx, int dy)
+{
+    int xtile, ytile, xstep, ystep;
+    word i, j, run, runleft;
+    word srcx, srcy, tile;
+
+    xstep = dx < 0 ? -1 : 1;
+    ystep = dy < 0 ? -1 : 1;
+
+    ytile = dy < 0 ? SCROLLH - 1 : 0;
+    for (i = 0; i < SCROLLH; i++, ytile += ystep) {
+        run = 0;
+        runleft = 0;
+
+        xtile = dx < 0 ? SCROLLW - 1 : 0;
+        for (j = 0; j < SCROLLW; j++, xtile += xstep) {
+            srcx = xtile + dx;
+            srcy = ytile + dy;
+            tile = *MAP_CELL_ADDR(scrollX + xtile, scrollY + ytile);
+
+            if (
+                srcx < SCROLLW && srcy < SCROLLH &&
+                tile >= TILE_STRIPED_PLATFORM && tile < TILE_MASKED_0 &&
+                !(dirtyCells[page][srcy][srcx >> 3] & (1 << (srcx & 7)))
+            ) {
+                /* Still on screen and undisturbed; extend the current run */
+                if (run == 0 || xtile < runleft) runleft = xtile;
+                run++;
+                continue;
+            }
+
+            if (run != 0) {
+                CopyScreenTiles(
+                    runleft + dx + 321 + ((ytile + dy) * 320),
+                    runleft + 321 + (ytile * 320), run
+                );
+                run = 0;
+            }
+
+            DrawMapCell(xtile, ytile, bdbase, ybd);
+        }
+
+        if (run != 0) {
+            CopyScreenTiles(
+                runleft + dx + 321 + ((ytile + dy) * 320),
+                runleft + 321 + (ytile * 320), run
+            );
+        }
+    }
+
+    memset(dirtyCells[page], 0, sizeof(dirtyCells[page]));
+}
+
+/*
+Mark every map region cell on both video pages as needing to be redrawn. This
+must be called whenever something draws into the map region of either page
+without marking what it covered, e.g. text frames and fullscreen images.
+*/
+void InvalidateMapRegion(void)
+{
+    pageScrollX[0] = WORD_MAX;
+    pageScrollX[1] = WORD_MAX;
 }
 
 /*
 Draw the static game world (backdrop plus all solid/masked map tiles), windowed
 to the current scroll position.
+
+Each video page remembers which scroll position it was last drawn at. If that
+hasn't changed, only the cells that were marked dirty since then are redrawn.
+If it has changed by a few tiles, the page is scrolled in place instead.
 */
 void DrawMapRegion(void)
 {
+    word page = !activePage;
     register int xtile;
     word destoff = 321;
     register word ymap;
@@ -699,6 +877,8 @@ void DrawMapRegion(void)
 
     if (scrollY > mapHeight) scrollY = mapHeight;
 
+    if (isHeadless) return;
+
     if (hasVScrollBackdrop && scrollY % 2 != 0) {
         bdbase += 0x2d00;
     }
@@ -709,6 +889,29 @@ void DrawMapRegion(void)
 
     EGA_MODE_LATCHED_WRITE();
 
+    if (scrollX == pageScrollX[page] && scrollY == pageScrollY[page]) {
+        DrawDirtyMapCells(page, bdbase, ybd);
+        return;
+    }
+
+    if (
+        pageScrollX[page] != WORD_MAX &&
+        scrollX + SCROLL_DELTA_MAX >= pageScrollX[page] &&
+        scrollX <= pageScrollX[page] + SCROLL_DELTA_MAX &&
+        scrollY + SCROLL_DELTA_MAX >= pageScrollY[page] &&
+        scrollY <= pageScrollY[page] + SCROLL_DELTA_MAX
+    ) {
+        ScrollMapRegion(page, bdbase, ybd,
+            scrollX - pageScrollX[page], scrollY - pageScrollY[page]);
+        pageScrollX[page] = scrollX;
+        pageScrollY[page] = scrollY;
+        return;
+    }
+
+    pageScrollX[page] = scrollX;
+    pageScrollY[page] = scrollY;
+    memset(dirtyCells[page], 0, sizeof(dirtyCells[page]));
+
     ymapmax = (scrollY + SCROLLH) << mapYPower;
     ymap = scrollY << mapYPower;
 
@@ -745,10 +948,10 @@ Is any part of the sprite frame at x,y visible within the screen's scroll area?
 bool IsSpriteVisible(word sprite, word frame, word x, word y)
 {
     register word width, height;
-    word offset = *(actorInfoData + sprite) + (frame * 4);
+    SpriteFrame *info = SPRITE_FRAME(sprite, frame);
 
-    height = *(actorInfoData + offset);
-    width = *(actorInfoData + offset + 1);
+    height = info->height;
+    width = info->width;
 
     if ((
         (scrollX <= x && scrollX + SCROLLW > x) ||
@@ -763,6 +966,78 @@ bool IsSpriteVisible(word sprite, word frame, word x, word y)
     return false;
 }
 
+/*
+Return `count` (1..16) consecutive bits from a collision plane, starting from
+bit number `start`, which ends up in the lowest bit of the result.
+*/
+word PlaneBits(word *plane, word start, word count)
+{
+    word shift = start & 15;
+    word bits = *(plane + (start >> 4)) >> shift;
+
+    if (shift + count > 16) {
+        bits |= *(plane + (start >> 4) + 1) << (16 - shift);
+    }
+
+    return bits & (WORD_MAX >> (16 - count));
+}
+
+/*
+Are all `count` consecutive bits in a collision plane, starting from bit number
+`start`, clear? Tests up to sixteen cells at a time.
+*/
+bool IsPlaneSpanClear(word *plane, word start, word count)
+{
+    for (; count > 16; count -= 16, start += 16) {
+        if (PlaneBits(plane, start, 16) != 0) return false;
+    }
+
+    return PlaneBits(plane, start, count) == 0;
+}
+
+/*
+Update the collision plane bits for the map cell at x,y to match its tile
+attributes.
+
+The north and south planes are laid out like the map itself, one row after the
+next, so a horizontal span of cells is a run of consecutive bits. The west and
+east planes are transposed (one column after the next) so that a vertical span
+of cells is. The south plane also has sloped cells set, since they stop a
+downward move too.
+*/
+void SetCollisionBits(word x, word y, byte attr)
+{
+    word row = ROW_BIT(x, y), column = COLUMN_BIT(x, y);
+    word rowmask = 1 << (row & 15), columnmask = 1 << (column & 15);
+
+    row >>= 4;
+    column >>= 4;
+
+    if (attr & TILEATTR_BLOCK_NORTH) {
+        *(northPlane + row) |= rowmask;
+    } else {
+        *(northPlane + row) &= ~rowmask;
+    }
+
+    if (attr & (TILEATTR_BLOCK_SOUTH | TILEATTR_SLOPED)) {
+        *(southPlane + row) |= rowmask;
+    } else {
+        *(southPlane + row) &= ~rowmask;
+    }
+
+    if (attr & TILEATTR_BLOCK_WEST) {
+        *(westPlane + column) |= columnmask;
+    } else {
+        *(westPlane + column) &= ~columnmask;
+    }
+
+    if (attr & TILEATTR_BLOCK_EAST) {
+        *(eastPlane + column) |= columnmask;
+    } else {
+        *(eastPlane + column) &= ~columnmask;
+    }
+}
+
 /*
 Can the passed sprite frame move to x,y considering the direction, and how?
 
@@ -773,30 +1048,31 @@ location where it currently is.
 word TestSpriteMove(word dir, word sprite, word frame, word x, word y)
 {
     register word i;
-    word *mapcell;
+    byte *attr;
     word width;
     register word height;
-    word offset = *(actorInfoData + sprite) + (frame * 4);
+    SpriteFrame *info = SPRITE_FRAME(sprite, frame);
 
-    height = *(actorInfoData + offset);
-    width = *(actorInfoData + offset + 1);
+    height = info->height;
+    width = info->width;
 
     switch (dir) {
     case DIR4_NORTH:
-        mapcell = MAP_CELL_ADDR(x, y - height + 1);
-
-        for (i = 0; i < width; i++) {
-            if (TILE_BLOCK_NORTH(*(mapcell + i))) return MOVE_BLOCKED;
+        if (!IsPlaneSpanClear(northPlane, ROW_BIT(x, y - height + 1), width)) {
+            return MOVE_BLOCKED;
         }
 
         break;
 
     case DIR4_SOUTH:
-        mapcell = MAP_CELL_ADDR(x, y);
+        if (IsPlaneSpanClear(southPlane, ROW_BIT(x, y), width)) break;
+
+        /* Something's there; the first sloped or blocking cell decides which */
+        attr = MAP_ATTR_ADDR(x, y);
 
         for (i = 0; i < width; i++) {
-            if (TILE_SLOPED(*(mapcell + i))) return MOVE_SLOPED;
-            if (TILE_BLOCK_SOUTH(*(mapcell + i))) return MOVE_BLOCKED;
+            if (*(attr + i) & TILEATTR_SLOPED) return MOVE_SLOPED;
+            if (*(attr + i) & TILEATTR_BLOCK_SOUTH) return MOVE_BLOCKED;
         }
 
         break;
@@ -804,17 +1080,15 @@ word TestSpriteMove(word dir, word sprite, word frame, word x, word y)
     case DIR4_WEST:
         if (x == 0) return MOVE_BLOCKED;
 
-        mapcell = MAP_CELL_ADDR(x, y);
+        attr = MAP_ATTR_ADDR(x, y);
 
-        for (i = 0; i < height; i++) {
-            if (
-                i == 0 &&
-                TILE_SLOPED(*mapcell) &&
-                !TILE_BLOCK_WEST(*(mapcell - mapWidth))
-            ) return MOVE_SLOPED;
+        if (
+            (*attr & TILEATTR_SLOPED) &&
+            !(*(attr - mapWidth) & TILEATTR_BLOCK_WEST)
+        ) return MOVE_SLOPED;
 
-            if (TILE_BLOCK_WEST(*mapcell)) return MOVE_BLOCKED;
-            mapcell -= mapWidth;
+        if (!IsPlaneSpanClear(westPlane, COLUMN_BIT(x, y - height + 1), height)) {
+            return MOVE_BLOCKED;
         }
 
         break;
@@ -822,17 +1096,15 @@ word TestSpriteMove(word dir, word sprite, word frame, word x, word y)
     case DIR4_EAST:
         if (x + width == mapWidth) return MOVE_BLOCKED;
 
-        mapcell = MAP_CELL_ADDR(x + width - 1, y);
+        attr = MAP_ATTR_ADDR(x + width - 1, y);
 
-        for (i = 0; i < height; i++) {
-            if (
-                i == 0 &&
-                TILE_SLOPED(*mapcell) &&
-                !TILE_BLOCK_EAST(*(mapcell - mapWidth))
-            ) return MOVE_SLOPED;
+        if (
+            (*attr & TILEATTR_SLOPED) &&
+            !(*(attr - mapWidth) & TILEATTR_BLOCK_EAST)
+        ) return MOVE_SLOPED;
 
-            if (TILE_BLOCK_EAST(*mapcell)) return MOVE_BLOCKED;
-            mapcell -= mapWidth;
+        if (!IsPlaneSpanClear(eastPlane, COLUMN_BIT(x + width - 1, y - height + 1), height)) {
+            return MOVE_BLOCKED;
         }
 
         break;
@@ -851,7 +1123,7 @@ location where they currently are.
 word TestPlayerMove(word dir, word x, word y)
 {
     word i;
-    word *mapcell;
+    byte *attr;
 
     isPlayerSlidingEast = false;
     isPlayerSlidingWest = false;
@@ -860,38 +1132,34 @@ word TestPlayerMove(word dir, word x, word y)
     case DIR4_NORTH:
         if (playerY - 3 == 0 || playerY - 2 == 0) return MOVE_BLOCKED;
 
-        mapcell = MAP_CELL_ADDR(x, y - 4);
-
-        for (i = 0; i < 3; i++) {
-            if (TILE_BLOCK_NORTH(*(mapcell + i))) return MOVE_BLOCKED;
-        }
+        if (!IsPlaneSpanClear(northPlane, ROW_BIT(x, y - 4), 3)) return MOVE_BLOCKED;
 
         break;
 
     case DIR4_SOUTH:
         if (mapHeight + SCROLLH == playerY) return MOVE_FREE;
 
-        mapcell = MAP_CELL_ADDR(x, y);
+        attr = MAP_ATTR_ADDR(x, y);
 
         if (
-            !TILE_BLOCK_SOUTH(*mapcell) &&
-            TILE_SLOPED(*mapcell) &&
-            TILE_SLIPPERY(*mapcell)
+            (*attr & (TILEATTR_BLOCK_SOUTH | TILEATTR_SLOPED | TILEATTR_SLIPPERY)) ==
+            (TILEATTR_SLOPED | TILEATTR_SLIPPERY)
         ) isPlayerSlidingEast = true;
 
         if (
-            !TILE_BLOCK_SOUTH(*(mapcell + 2)) &&
-            TILE_SLOPED(*(mapcell + 2)) &&
-            TILE_SLIPPERY(*(mapcell + 2))
+            (*(attr + 2) & (TILEATTR_BLOCK_SOUTH | TILEATTR_SLOPED | TILEATTR_SLIPPERY)) ==
+            (TILEATTR_SLOPED | TILEATTR_SLIPPERY)
         ) isPlayerSlidingWest = true;
 
+        if (IsPlaneSpanClear(southPlane, ROW_BIT(x, y), 3)) break;
+
         for (i = 0; i < 3; i++) {
-            if (TILE_SLOPED(*(mapcell + i))) {
+            if (*(attr + i) & TILEATTR_SLOPED) {
                 pounceStreak = 0;
                 return MOVE_SLOPED;
             }
 
-            if (TILE_BLOCK_SOUTH(*(mapcell + i))) {
+            if (*(attr + i) & TILEATTR_BLOCK_SOUTH) {
                 pounceStreak = 0;
                 return MOVE_BLOCKED;
             }
@@ -900,38 +1168,30 @@ word TestPlayerMove(word dir, word x, word y)
         break;
 
     case DIR4_WEST:
-        mapcell = MAP_CELL_ADDR(x, y);
-        canPlayerCling = TILE_CAN_CLING(*(mapcell - (mapWidth * 2)));
-
-        for (i = 0; i < 5; i++) {
-            if (TILE_BLOCK_WEST(*mapcell)) return MOVE_BLOCKED;
+        attr = MAP_ATTR_ADDR(x, y);
+        canPlayerCling = *(attr - (mapWidth * 2)) & TILEATTR_CAN_CLING;
 
-            if (
-                i == 0 &&
-                TILE_SLOPED(*mapcell) &&
-                !TILE_BLOCK_WEST(*(mapcell - mapWidth))
-            ) return MOVE_SLOPED;
+        /* A blocking bottom cell wins over a slope there */
+        if (
+            (*attr & (TILEATTR_BLOCK_WEST | TILEATTR_SLOPED)) == TILEATTR_SLOPED &&
+            !(*(attr - mapWidth) & TILEATTR_BLOCK_WEST)
+        ) return MOVE_SLOPED;
 
-            mapcell -= mapWidth;
-        }
+        if (!IsPlaneSpanClear(westPlane, COLUMN_BIT(x, y - 4), 5)) return MOVE_BLOCKED;
 
         break;
 
     case DIR4_EAST:
-        mapcell = MAP_CELL_ADDR(x + 2, y);
-        canPlayerCling = TILE_CAN_CLING(*(mapcell - (mapWidth * 2)));
-
-        for (i = 0; i < 5; i++) {
-            if (TILE_BLOCK_EAST(*mapcell)) return MOVE_BLOCKED;
+        attr = MAP_ATTR_ADDR(x + 2, y);
+        canPlayerCling = *(attr - (mapWidth * 2)) & TILEATTR_CAN_CLING;
 
-            if (
-                i == 0 &&
-                TILE_SLOPED(*mapcell) &&
-                !TILE_BLOCK_EAST(*(mapcell - mapWidth))
-            ) return MOVE_SLOPED;
+        /* A blocking bottom cell wins over a slope there */
+        if (
+            (*attr & (TILEATTR_BLOCK_EAST | TILEATTR_SLOPED)) == TILEATTR_SLOPED &&
+            !(*(attr - mapWidth) & TILEATTR_BLOCK_EAST)
+        ) return MOVE_SLOPED;
 
-            mapcell -= mapWidth;
-        }
+        if (!IsPlaneSpanClear(eastPlane, COLUMN_BIT(x + 2, y - 4), 5)) return MOVE_BLOCKED;
 
         break;
     }
@@ -945,13 +1205,13 @@ Is the passed sprite frame at x,y touching the player's sprite?
 bool IsTouchingPlayer(word sprite, word frame, word x, word y)
 {
     register word height, width;
-    word offset;
+    SpriteFrame *info;
 
     if (playerDeadTime != 0) return false;
 
-    offset = *(actorInfoData + sprite) + (frame * 4);
-    height = *(actorInfoData + offset);
-    width = *(actorInfoData + offset + 1);
+    info = SPRITE_FRAME(sprite, frame);
+    height = info->height;
+    width = info->width;
 
     if (x > mapWidth && x <= WORD_MAX && sprite == SPR_EXPLOSION) {
         width = x + width;
@@ -967,46 +1227,6 @@ bool IsTouchingPlayer(word sprite, word frame, word x, word y)
     return false;
 }
 
-/*
-Is the passed sprite frame at x,y (#1) touching another passed sprite (#2)?
-
-Only used by IsNearExplosion().
-*/
-bool IsIntersecting(
-    word sprite1, word frame1, word x1, word y1,
-    word sprite2, word frame2, word x2, word y2
-) {
-    word width1;
-    register word height1;
-    word offset1;
-    word width2;
-    register word height2;
-    word offset2;
-
-    offset1 = *(actorInfoData + sprite1) + (frame1 * 4);
-    height1 = *(actorInfoData + offset1);
-    width1 = *(actorInfoData + offset1 + 1);
-
-    offset2 = *(actorInfoData + sprite2) + (frame2 * 4);
-    height2 = *(actorInfoData + offset2);
-    width2 = *(actorInfoData + offset2 + 1);
-
-    if (x1 > mapWidth && x1 <= WORD_MAX) {
-        width1 = x1 + width1;
-        x1 = 0;
-    }
-
-    if ((
-        (x2 <= x1 && x2 + width2 > x1) || (x2 >= x1 && x1 + width1 > x2)
-    ) && (
-        (y1 - height1 < y2 && y2 <= y1) || (y2 - height2 < y1 && y1 <= y2)
-    )) {
-        return true;
-    }
-
-    return false;
-}
-
 /*
 Draw an actor sprite frame at {x,y}_origin with the requested mode.
 */
@@ -1015,17 +1235,19 @@ void DrawSprite(word sprite, word frame, word x_origin, word y_origin, word mode
     word x = x_origin;
     word y;
     word height, width;
-    word offset;
+    SpriteFrame *info;
     byte *src;
     DrawFunction drawfn;
 
+    if (isHeadless) return;
+
     EGA_MODE_DEFAULT();
 
-    offset = *(actorInfoData + sprite) + (frame * 4);
-    height = *(actorInfoData + offset);
-    width = *(actorInfoData + offset + 1);
+    info = SPRITE_FRAME(sprite, frame);
+    height = info->height;
+    width = info->width;
 
-    src = actorTileData[*(actorInfoData + offset + 3)] + *(actorInfoData + offset + 2);
+    src = info->tiles;
 
     switch (mode) {
     case DRAWMODE_NORMAL:
@@ -1051,9 +1273,10 @@ void DrawSprite(word sprite, word frame, word x_origin, word y_origin, word mode
         if (
             x >= scrollX && scrollX + SCROLLW > x &&
             y >= scrollY && scrollY + SCROLLH > y &&
-            !TILE_IN_FRONT(*(mapData.w + x + (y << mapYPower)))
+            !(*MAP_ATTR_ADDR(x, y) & TILEATTR_IN_FRONT)
         ) {
             drawfn(src, (x - scrollX) + 1, (y - scrollY) + 1);
+            MARK_SCREEN_TILE((x - scrollX) + 1, (y - scrollY) + 1);
         }
 
         src += 40;
@@ -1078,9 +1301,10 @@ flipped:
         if (
             x >= scrollX && scrollX + SCROLLW > x &&
             y >= scrollY && scrollY + SCROLLH > y &&
-            !TILE_IN_FRONT(*(mapData.w + x + (y << mapYPower)))
+            !(*MAP_ATTR_ADDR(x, y) & TILEATTR_IN_FRONT)
         ) {
             DrawSpriteTileFlipped(src, (x - scrollX) + 1, (y - scrollY) + 1);
+            MARK_SCREEN_TILE((x - scrollX) + 1, (y - scrollY) + 1);
         }
 
         src += 40;
@@ -1104,6 +1328,7 @@ infront:
             y >= scrollY && scrollY + SCROLLH > y
         ) {
             drawfn(src, (x - scrollX) + 1, (y - scrollY) + 1);
+            MARK_SCREEN_TILE((x - scrollX) + 1, (y - scrollY) + 1);
         }
 
         src += 40;
@@ -1123,6 +1348,7 @@ absolute:
     y = (y_origin - height) + 1;
     for (;;) {
         DrawSpriteTile(src, x, y);  /* could've been drawfn */
+        MARK_SCREEN_TILE(x, y);
 
         src += 40;
 
@@ -1148,6 +1374,8 @@ void DrawPlayer(byte frame, word x_origin, word y_origin, word mode)
     byte *src;
     DrawFunction drawfn;
 
+    if (isHeadless) return;
+
     EGA_MODE_DEFAULT();
 
     switch (mode) {
@@ -1187,9 +1415,10 @@ void DrawPlayer(byte frame, word x_origin, word y_origin, word mode)
         if (
             x >= scrollX && scrollX + SCROLLW > x &&
             y >= scrollY && scrollY + SCROLLH > y &&
-            !TILE_IN_FRONT(*(mapData.w + x + (y << mapYPower)))
+            !(*MAP_ATTR_ADDR(x, y) & TILEATTR_IN_FRONT)
         ) {
             drawfn(src, (x - scrollX) + 1, (y - scrollY) + 1);
+            MARK_SCREEN_TILE((x - scrollX) + 1, (y - scrollY) + 1);
         }
 
         src += 40;
@@ -1208,6 +1437,7 @@ void DrawPlayer(byte frame, word x_origin, word y_origin, word mode)
 absolute:
     for (;;) {
         DrawSpriteTile(src, x, y);  /* could've been drawfn */
+        MARK_SCREEN_TILE(x, y);
 
         src += 40;
 
@@ -1229,6 +1459,7 @@ infront:
             y >= scrollY && scrollY + SCROLLH > y
         ) {
             drawfn(src, (x - scrollX) + 1, (y - scrollY) + 1);
+            MARK_SCREEN_TILE((x - scrollX) + 1, (y - scrollY) + 1);
         }
 
         src += 40;
@@ -1248,10 +1479,11 @@ Load cartoon data into system memory.
 */
 void LoadCartoonData(char *entry_name)
 {
-    FILE *fp = GroupEntryFp(entry_name);
+    GroupView view;
 
-    fread(mapData.b, (word)GroupEntryLength(entry_name), 1, fp);
-    fclose(fp);
+    GroupEntryView(entry_name, &view);
+    ReadGroupView(&view, mapData.b, (word)view.length);
+    CloseGroupView(&view);
 }
 
 /*
@@ -1282,6 +1514,7 @@ void DrawCartoon(byte frame, word x_origin, word y_origin)
 
     for (;;) {
         DrawSpriteTile(src, x, y);
+        MARK_SCREEN_TILE(x, y);
 
         src += 40;
 
@@ -1516,7 +1749,7 @@ void DrawLights(void)
 {
     register word i;
 
-    if (!areLightsActive) return;
+    if (!areLightsActive || isHeadless) return;
 
     EGA_MODE_DEFAULT();
 
@@ -1539,60 +1772,158 @@ void DrawLights(void)
             } else {  /* SPA_LIGHT_EAST */
                 LightenScreenTileEast(xorigin - scrollX + 1, yorigin - scrollY + 1);
             }
+            MARK_SCREEN_TILE(xorigin - scrollX + 1, yorigin - scrollY + 1);
         }
 
         for (y = yorigin + 1; yorigin + LIGHT_CAST_DISTANCE > y; y++) {
-            if (TILE_BLOCK_SOUTH(GetMapTile(xorigin, y))) break;
+            if (*MAP_ATTR_ADDR(xorigin, y) & TILEATTR_BLOCK_SOUTH) break;
 
             if (
                 xorigin >= scrollX && scrollX + SCROLLW > xorigin &&
                 y >= scrollY && scrollY + SCROLLH - 1 >= y
             ) {
                 LightenScreenTile(xorigin - scrollX + 1, y - scrollY + 1);
+                MARK_SCREEN_TILE(xorigin - scrollX + 1, y - scrollY + 1);
             }
         }
     }
 }
 
 /*
-Create the specified actor at the current nextActorIndex.
+Forget every actor's scheduling state. Must be called before a new map's actors
+are constructed.
 */
-void ConstructActor(
-    word sprite, word x, word y, bool force_active, bool stay_active,
-    bool weighted, bool acrophile, ActorTickFunction tick_func, word data1,
-    word data2, word data3, word data4, word data5
-) {
-    Actor *act;
+void ClearActorSchedule(void)
+{
+    memset(awakeActors, 0, sizeof(awakeActors));
+    memset(deadActors, 0, sizeof(deadActors));
+    memset(dormantHead, 0xff, sizeof(dormantHead));
+    memset(dormantBucket, ACTOR_NOT_DORMANT, sizeof(dormantBucket));
+}
 
-    if (data2 == SPR_BARREL_SHARDS || data2 == SPR_BASKET_SHARDS) {
-        numBarrels++;
-    }
+/*
+Make sure the actor at `index` is processed every frame from now on. Called for
+each actor slot that gets (re)constructed.
+*/
+void WakeActor(word index)
+{
+    word *link;
 
-    act = actors + nextActorIndex;
+    if (dormantBucket[index] != ACTOR_NOT_DORMANT) {
+        link = dormantHead + dormantBucket[index];
+        while (*link != index) {
+            link = dormantNext + *link;
+        }
 
-    act->sprite = sprite;
-    act->frame = 0;
-    act->x = x;
-    act->y = y;
-    act->forceactive = force_active;
-    act->stayactive = stay_active;
-    act->weighted = weighted;
-    act->acrophile = acrophile;
-    act->dead = false;
-    act->tickfunc = tick_func;
-    act->private1 = 0;
-    act->private2 = 0;
-    act->fallspeed = 0;
-    act->data1 = data1;
-    act->data2 = data2;
-    act->data3 = data3;
-    act->data4 = data4;
-    act->data5 = data5;
-    act->damagecooldown = 0;
+        *link = dormantNext[index];
+        dormantBucket[index] = ACTOR_NOT_DORMANT;
+    }
+
+    awakeActors[index >> 3] |= 1 << (index & 7);
 }
 
 /*
-Ensure that the numbered actor moved to a valid place, and adjust if not.
+Stop processing the actor at `index` every frame. Unless the actor is dead, it
+goes into the bucket for its map column so WakeVisibleActors() can find it.
+*/
+void SleepActor(word index)
+{
+    Actor *act = actors + index;
+    word bucket;
+
+    awakeActors[index >> 3] &= ~(1 << (index & 7));
+
+    if (act->dead) return;
+
+    bucket = act->x >> ACTOR_BUCKET_SHIFT;
+    if (bucket > ACTOR_BUCKETS - 1) bucket = ACTOR_BUCKETS - 1;
+
+    dormantNext[index] = dormantHead[bucket];
+    dormantHead[bucket] = index;
+    dormantBucket[index] = (byte)bucket;
+}
+
+/*
+Wake every sleeping actor that the screen has scrolled over. Only the buckets
+for map columns where a visible sprite could begin are searched.
+
+A sleeping actor can't move, change frames, or become force-active. The only
+thing that can happen to it is being killed by another actor (e.g. a door
+being unlocked), so dead ones are dropped here as they're encountered.
+*/
+void WakeVisibleActors(void)
+{
+    word bucket, lastbucket, index;
+    word *link;
+    Actor *act;
+
+    bucket = scrollX < maxSpriteWidth ?
+        0 : (scrollX - maxSpriteWidth + 1) >> ACTOR_BUCKET_SHIFT;
+    lastbucket = (scrollX + SCROLLW - 1) >> ACTOR_BUCKET_SHIFT;
+    if (lastbucket > ACTOR_BUCKETS - 1) lastbucket = ACTOR_BUCKETS - 1;
+
+    for (; bucket <= lastbucket; bucket++) {
+        link = dormantHead + bucket;
+
+        while (*link != WORD_MAX) {
+            index = *link;
+            act = actors + index;
+
+            if (!act->dead && !IsSpriteVisible(act->sprite, act->frame, act->x, act->y)) {
+                link = dormantNext + index;
+                continue;
+            }
+
+            *link = dormantNext[index];
+            dormantBucket[index] = ACTOR_NOT_DORMANT;
+
+            if (!act->dead) awakeActors[index >> 3] |= 1 << (index & 7);
+        }
+    }
+}
+
+/*
+Create the specified actor at the current nextActorIndex.
+*/
+void ConstructActor(
+    word sprite, word x, word y, bool force_active, bool stay_active,
+    bool weighted, bool acrophile, ActorTickFunction tick_func, word data1,
+    word data2, word data3, word data4, word data5
+) {
+    Actor *act;
+
+    if (data2 == SPR_BARREL_SHARDS || data2 == SPR_BASKET_SHARDS) {
+        numBarrels++;
+    }
+
+    WakeActor(nextActorIndex);
+
+    act = actors + nextActorIndex;
+
+    act->sprite = sprite;
+    act->frame = 0;
+    act->x = x;
+    act->y = y;
+    act->forceactive = force_active;
+    act->stayactive = stay_active;
+    act->weighted = weighted;
+    act->acrophile = acrophile;
+    act->dead = false;
+    deadActors[nextActorIndex >> 3] &= ~(1 << (nextActorIndex & 7));
+    act->tickfunc = tick_func;
+    act->private1 = 0;
+    act->private2 = 0;
+    act->fallspeed = 0;
+    act->data1 = data1;
+    act->data2 = data2;
+    act->data3 = data3;
+    act->data4 = data4;
+    act->data5 = data5;
+    act->damagecooldown = 0;
+}
+
+/*
+Ensure that the numbered actor moved to a valid place, and adjust if not.
 
 Actors modified by this function move left/right while negotiating slopes. The
 actor should have already been (blindly) moved into the desired location, then
@@ -1605,12 +1936,10 @@ as-is. private2 is changed the same way for eastward movement.
 void AdjustActorMove(word index, word dir)
 {
     Actor *act = actors + index;
-    word offset;
     word width;
     word result = 0;
 
-    offset = *(actorInfoData + act->sprite);
-    width = *(actorInfoData + offset + 1);
+    width = SPRITE_FRAME(act->sprite, 0)->width;
 
     if (dir == DIR4_WEST) {
         result = TestSpriteMove(DIR4_WEST, act->sprite, act->frame, act->x, act->y);
@@ -1938,7 +2267,7 @@ void UpdateDoors(word door_sprite, Actor *act_switch)
         if (door->sprite != door_sprite) continue;
 
         if (act_switch->data1 == 2) {
-            door->dead = true;
+            KILL_ACTOR(door);
             StartSound(SND_DOOR_UNLOCK);
 
             NewDecoration(door_sprite, 1, door->x, door->y, DIR8_SOUTH, 5);
@@ -2090,7 +2419,7 @@ void ActBombArmed(word index)
         }
 
         if (act->data2 == 10) {
-            act->dead = true;
+            KILL_ACTOR(act);
             NewPounceDecoration(act->x - 2, act->y + 2);
             nextDrawMode = DRAWMODE_HIDDEN;
             NewExplosion(act->x - 2, act->y);
@@ -2463,7 +2792,7 @@ void ActPyramid(word index)
         }
 
     } else if (TestSpriteMove(DIR4_SOUTH, act->sprite, 0, act->x, act->y + 1) != MOVE_FREE) {
-        act->dead = true;
+        KILL_ACTOR(act);
         NewDecoration(SPR_SMOKE, 6, act->x, act->y, DIR8_NORTH, 3);
         StartSound(SND_BIG_OBJECT_HIT);
         nextDrawMode = DRAWMODE_HIDDEN;
@@ -2480,7 +2809,7 @@ void ActPyramid(word index)
 
             if (act->data2 == 0) {
                 NewExplosion(act->x - 1, act->y + 1);
-                act->dead = true;
+                KILL_ACTOR(act);
                 AddScore(200);
                 NewShard(act->sprite, 0, act->x, act->y);
             }
@@ -2504,7 +2833,7 @@ void ActGhost(word index)
 
     if (playerBaseFrame == PLAYER_BASE_WEST) {
         if (act->x > playerX + 2 && playerClingDir == DIR4_WEST && cmdEast) {
-            act->frame = (random(35) == 0 ? 4 : 0) + 2;
+            act->frame = (WORLD_RANDOM(35) == 0 ? 4 : 0) + 2;
         } else if (act->x > playerX) {
             act->frame = act->data1 % 2;
             if (act->data1 == 0) {
@@ -2516,11 +2845,11 @@ void ActGhost(word index)
                 }
             }
         } else {
-            act->frame = (random(35) == 0 ? 2 : 0) + 5;
+            act->frame = (WORLD_RANDOM(35) == 0 ? 2 : 0) + 5;
         }
     } else {
         if (act->x < playerX && playerClingDir == DIR4_EAST && cmdWest) {
-            act->frame = (random(35) == 0 ? 2 : 0) + 5;
+            act->frame = (WORLD_RANDOM(35) == 0 ? 2 : 0) + 5;
         } else if (act->x < playerX) {
             act->frame = (act->data1 % 2) + 3;
             if (act->data1 == 0) {
@@ -2532,7 +2861,7 @@ void ActGhost(word index)
                 }
             }
         } else {
-            act->frame = (random(35) == 0 ? 4 : 0) + 2;
+            act->frame = (WORLD_RANDOM(35) == 0 ? 4 : 0) + 2;
         }
     }
 }
@@ -2601,7 +2930,7 @@ void ActBombIdle(word index)
 
     if (act->data1 == 2) {
         NewExplosion(act->x - 2, act->y);
-        act->dead = true;
+        KILL_ACTOR(act);
 
     } else {
         if (act->data1 != 0) act->data1++;
@@ -2617,7 +2946,25 @@ Set map tile at x,y to `value`.
 */
 void SetMapTile(word value, word x, word y)
 {
-    *(mapData.w + x + (y << mapYPower)) = value;
+    word *cell = mapData.w + x + (y << mapYPower);
+    word page, xcell, ycell;
+
+    if (*cell == value) return;
+
+    *cell = value;
+    mapHash = UpdateCRC16(mapHash ^ (x + (y << mapYPower)), &value, 2);
+    *MAP_ATTR_ADDR(x, y) = TILE_ATTR(value);
+    SetCollisionBits(x, y, TILE_ATTR(value));
+
+    /* Each page needs this cell redrawn if it's within that page's view. */
+    for (page = 0; page < 2; page++) {
+        xcell = x - pageScrollX[page];
+        ycell = y - pageScrollY[page];
+
+        if (xcell < SCROLLW && ycell < SCROLLH) {
+            dirtyCells[page][ycell][xcell >> 3] |= 1 << (xcell & 7);
+        }
+    }
 }
 
 /*
@@ -2647,7 +2994,7 @@ void ActMysteryWall(word index)
             SetMapTile(TILE_MYSTERY_BLOCK_SE, act->x + 1, act->y - 1);
         }
 
-        act->dead = true;
+        KILL_ACTOR(act);
 
     } else {
         if (act->data1 % 2 == 0) {
@@ -2719,7 +3066,7 @@ void ActProjectile(word index)
     Actor *act = actors + index;
 
     if (!IsSpriteVisible(SPR_PROJECTILE, 0, act->x, act->y)) {
-        act->dead = true;
+        KILL_ACTOR(act);
         return;
     }
 
@@ -2883,7 +3230,7 @@ void ActBabyGhostEgg(word index)
     if (act->data2 > 1) {
         act->data2--;
     } else if (act->data2 == 1) {
-        act->dead = true;
+        KILL_ACTOR(act);
         nextDrawMode = DRAWMODE_HIDDEN;
 
         NewActor(ACT_BABY_GHOST, act->x, act->y);
@@ -3086,7 +3433,7 @@ void ActBeamRobot(word index)
             NewActor(ACT_STAR_FLOAT, act->x, act->y - i);
         }
 
-        act->dead = true;
+        KILL_ACTOR(act);
 
         return;
     }
@@ -3265,7 +3612,7 @@ void ActEyePlant(word index)
 
     nextDrawMode = act->data5;
 
-    act->data2 = random(40);
+    act->data2 = WORLD_RANDOM(40);
     if (act->data2 > 37) {
         act->data2 = 3;
     } else {
@@ -3867,14 +4214,14 @@ void ActTransporter(word index)
 
     nextDrawMode = DRAWMODE_HIDDEN;
 
-    if (transporterTimeLeft != 0 && random(2U) != 0) {
+    if (transporterTimeLeft != 0 && WORLD_RANDOM(2U) != 0) {
         DrawSprite(SPR_TRANSPORTER_107, 0, act->x, act->y, DRAWMODE_WHITE);
     } else {
         DrawSprite(SPR_TRANSPORTER_107, 0, act->x, act->y, DRAWMODE_NORMAL);
     }
 
     if (GameRand() % 2 != 0) {
-        DrawSprite(SPR_TRANSPORTER_107, random(2U) + 1, act->x, act->y, DRAWMODE_NORMAL);
+        DrawSprite(SPR_TRANSPORTER_107, WORLD_RANDOM(2U) + 1, act->x, act->y, DRAWMODE_NORMAL);
     }
 
     if (transporterTimeLeft == 15) {
@@ -4150,7 +4497,7 @@ void ActForceField(word index)
     nextDrawMode = DRAWMODE_HIDDEN;
 
     if (!areForceFieldsActive) {
-        act->dead = true;
+        KILL_ACTOR(act);
         return;
     }
 
@@ -4192,7 +4539,7 @@ void ActPinkWorm(word index)
         if (act->data4 != 0) return;
     }
 
-    if (random(40) > 37 && act->data3 == 0 && act->data2 == 0) {
+    if (WORLD_RANDOM(40) > 37 && act->data3 == 0 && act->data2 == 0) {
         act->data3 = 4;
     }
 
@@ -4498,7 +4845,7 @@ void ActWormCrate(word index)
         if (act->data5 != 0) {
             act->data5--;
         } else {
-            act->dead = true;
+            KILL_ACTOR(act);
             if (act->private2 == WORM_CRATE_EXPLODE) {
                 NewExplosion(act->x - 1, act->y - 1);
             }
@@ -4542,7 +4889,7 @@ void ActSatellite(word index)
             act->data1 = 1;
             act->data2 = 15;
         } else {
-            act->dead = true;
+            KILL_ACTOR(act);
             nextDrawMode = DRAWMODE_WHITE;
             StartSound(SND_DESTROY_SATELLITE);
 
@@ -4715,10 +5062,10 @@ void ActPrize(word index)
 
     if (act->frame == act->data5) act->frame = 0;
 
-    if (act->data5 == 1 && act->sprite != SPR_THRUSTER_JET && act->data4 == 0 && random(64U) == 0) {
+    if (act->data5 == 1 && act->sprite != SPR_THRUSTER_JET && act->data4 == 0 && WORLD_RANDOM(64U) == 0) {
         NewDecoration(
             SPR_SPARKLE_LONG, 8,
-            random(act->data1) + act->x, random(act->data2) + act->y, DIR8_STATIONARY, 1
+            WORLD_RANDOM(act->data1) + act->x, WORLD_RANDOM(act->data2) + act->y, DIR8_STATIONARY, 1
         );
     }
 }
@@ -4756,14 +5103,14 @@ void ActBearTrap(word index)
         if (IsNearExplosion(act->sprite, act->frame, act->x, act->y)) {
             AddScore(250);
             NewShard(act->sprite, act->frame, act->x, act->y);
-            act->dead = true;
+            KILL_ACTOR(act);
             blockMovementCmds = false;
         }
 
     } else if (IsNearExplosion(act->sprite, act->frame, act->x, act->y)) {
         AddScore(250);
         NewShard(act->sprite, act->frame, act->x, act->y);
-        act->dead = true;
+        KILL_ACTOR(act);
     }
 }
 
@@ -4775,7 +5122,7 @@ void ActFallingFloor(word index)
     Actor *act = actors + index;
 
     if (TestSpriteMove(DIR4_SOUTH, SPR_FALLING_FLOOR, 0, act->x, act->y + 1) != MOVE_FREE) {
-        act->dead = true;
+        KILL_ACTOR(act);
         NewShard(SPR_FALLING_FLOOR, 1, act->x, act->y);
         NewShard(SPR_FALLING_FLOOR, 2, act->x, act->y);
         StartSound(SND_DESTROY_SOLID);
@@ -4849,7 +5196,7 @@ void ActScoreEffect(word index)
         act->data1 == 100 ||
         !IsSpriteVisible(act->sprite, act->frame, act->x, act->y)
     ) {
-        act->dead = true;
+        KILL_ACTOR(act);
         nextDrawMode = DRAWMODE_HIDDEN;
     }
 
@@ -4903,13 +5250,13 @@ void ActBird(word index)
 
     if (act->data1 == 0) {
         if (act->x + 1 > playerX) {
-            if (random(10) == 0) {
+            if (WORLD_RANDOM(10) == 0) {
                 act->data2 = 1;
             } else {
                 act->data2 = 0;
             }
         } else {
-            if (random(10) == 0) {
+            if (WORLD_RANDOM(10) == 0) {
                 act->data2 = 5;
             } else {
                 act->data2 = 4;
@@ -5046,7 +5393,7 @@ void ActRocket(word index)
     }
 
     if (act->data5 != 0) {
-        act->dead = true;
+        KILL_ACTOR(act);
         NewShard(SPR_ROCKET, 1, act->x,     act->y);
         NewShard(SPR_ROCKET, 2, act->x + 1, act->y);
         NewShard(SPR_ROCKET, 3, act->x + 2, act->y);
@@ -5089,7 +5436,7 @@ void ActPedestal(word index)
         act->data1--;
 
         if (act->data1 == 1) {
-            act->dead = true;
+            KILL_ACTOR(act);
             NewShard(SPR_PEDESTAL, 0, act->x, act->y);
         } else {
             NewShard(SPR_PEDESTAL, 1, act->x, act->y);
@@ -5118,7 +5465,7 @@ void ActInvincibilityBubble(word index)
     }
 
     if (act->data1 == 240) {
-        act->dead = true;
+        KILL_ACTOR(act);
         nextDrawMode = DRAWMODE_HIDDEN;
         playerIsInvincible = false;
     } else {
@@ -5136,7 +5483,7 @@ void ActMonument(word index)
     int i;
 
     if (act->data2 != 0) {
-        act->dead = true;
+        KILL_ACTOR(act);
         nextDrawMode = DRAWMODE_HIDDEN;
         NewShard(SPR_MONUMENT, 3, act->x,     act->y - 8);
         NewShard(SPR_MONUMENT, 3, act->x,     act->y - 7);
@@ -5208,7 +5555,7 @@ void ActTulipLauncher(word index)
 
         act->data5++;
         if (act->data5 == 2) {
-            act->dead = true;
+            KILL_ACTOR(act);
             NewShard(SPR_PARACHUTE_BALL, 0, act->x + 2, act->y - 5);
             NewShard(SPR_PARACHUTE_BALL, 2, act->x + 2, act->y - 5);
             NewShard(SPR_PARACHUTE_BALL, 4, act->x + 2, act->y - 5);
@@ -5318,7 +5665,7 @@ void ActFrozenDN(word index)
         act->y--;
 
         if (act->data2 > 50 || !IsSpriteVisible(SPR_FROZEN_DN, 2, act->x, act->y)) {
-            act->dead = true;
+            KILL_ACTOR(act);
         } else {
             DrawSprite(SPR_FROZEN_DN, (act->data5++ % 2) + 4, act->x, act->y + 5, DRAWMODE_NORMAL);
             DrawSprite(SPR_FROZEN_DN, 2, act->x, act->y, DRAWMODE_NORMAL);
@@ -5379,7 +5726,7 @@ void ActSpeechBubble(word index)
     act->data1++;
 
     if (act->data1 == 20) {
-        act->dead = true;
+        KILL_ACTOR(act);
     } else {
         DrawSprite(act->sprite, 0, playerX - 1, playerY - 5, DRAWMODE_IN_FRONT);
     }
@@ -6164,25 +6511,30 @@ bbool NewActorAtIndex(word index, word actor_type, word x, word y)
 }
 
 /*
-Add a new actor of the specified type at x,y. This function finds a free slot.
+Add a new actor of the specified type at x,y. This function finds a free slot:
+the lowest-numbered dead actor if there is one, otherwise a new one at the end.
 */
 void NewActor(word actor_type, word x, word y)
 {
     Actor *act;
     word i;
 
-    for (i = 0; i < numActors; i++) {
-        act = actors + i;
+    for (i = 0; i < numActors; i += 8) {
+        if (deadActors[i >> 3] == 0) continue;
 
-        if (act->dead) {
-            NewActorAtIndex(i, actor_type, x, y);
+        while (!(deadActors[i >> 3] & (1 << (i & 7)))) {
+            i++;
+        }
 
-            if (actor_type == ACT_PARACHUTE_BALL) {
-                act->forceactive = true;
-            }
+        act = actors + i;
 
-            return;
+        NewActorAtIndex(i, actor_type, x, y);
+
+        if (actor_type == ACT_PARACHUTE_BALL) {
+            act->forceactive = true;
         }
+
+        return;
     }
 
     if (numActors < MAX_ACTORS - 2) {
@@ -6203,11 +6555,11 @@ Add sparkles to slippery areas of the map; add raindrops to empty areas of sky.
 */
 void DrawRandomEffects(void)
 {
-    word x = random(SCROLLW) + scrollX;
-    word y = random(SCROLLH) + scrollY;
+    word x = WORLD_RANDOM(SCROLLW) + scrollX;
+    word y = WORLD_RANDOM(SCROLLH) + scrollY;
     word maptile = GetMapTile(x, y);
 
-    if (random(2U) != 0 && TILE_SLIPPERY(maptile)) {
+    if (WORLD_RANDOM(2U) != 0 && TILE_SLIPPERY(maptile)) {
         NewDecoration(SPR_SPARKLE_SLIPPERY, 5, x, y, DIR8_STATIONARY, 1);
     }
 
@@ -6239,15 +6591,10 @@ Insert the requested shard into the first free spot in the shards array.
 */
 void NewShard(word sprite, word frame, word x, word y)
 {
-    /*
-    INTERESTING: This never gets reset, so shard behavior is different for each
-    run through the demo playback.
-    */
-    static word inclination = 0;
     word i;
 
-    inclination++;
-    if (inclination == 5) inclination = 0;
+    shardInclination++;
+    if (shardInclination == 5) shardInclination = 0;
 
     for (i = 0; i < numShards; i++) {
         Shard *sh = shards + i;
@@ -6258,7 +6605,7 @@ void NewShard(word sprite, word frame, word x, word y)
             sh->y = y;
             sh->frame = frame;
             sh->age = 1;
-            sh->inclination = inclination;
+            sh->inclination = shardInclination;
             sh->bounced = false;
 
             break;
@@ -6358,6 +6705,29 @@ restart:
 
 static word numExplosions = MAX_EXPLOSIONS;
 
+/*
+Empty the explosion bounding box, so nothing is considered near an explosion.
+*/
+void ClearExplosionBox(void)
+{
+    explosionBoxLeft = explosionBoxTop = WORD_MAX;
+    explosionBoxRight = explosionBoxBottom = 0;
+}
+
+/*
+Widen the explosion bounding box to include the passed explosion rectangle.
+*/
+void AddToExplosionBox(ExplosionRect *rect)
+{
+    /* An explosion at the very top of the map has a top edge above row zero */
+    word top = rect->y >= rect->height ? rect->y - rect->height + 1 : 0;
+
+    if (rect->x < explosionBoxLeft)                 explosionBoxLeft = rect->x;
+    if (rect->x + rect->width > explosionBoxRight)  explosionBoxRight = rect->x + rect->width;
+    if (top < explosionBoxTop)                      explosionBoxTop = top;
+    if (rect->y + 1 > explosionBoxBottom)           explosionBoxBottom = rect->y + 1;
+}
+
 /*
 Deactivate every element in the explosions array, freeing them for re-use.
 */
@@ -6368,6 +6738,8 @@ void InitializeExplosions(void)
     for (i = 0; i < numExplosions; i++) {
         explosions[i][0] = 0;
     }
+
+    ClearExplosionBox();
 }
 
 /*
@@ -6386,6 +6758,24 @@ void NewExplosion(word x, word y)
         ex->x = x;
         ex->y = y + 2;
 
+        {
+            /* Explosions don't move, so their extents can be worked out now. */
+            ExplosionRect *rect = explosionRects + i;
+            SpriteFrame *info = SPRITE_FRAME(SPR_EXPLOSION, 0);
+
+            rect->x = ex->x;
+            rect->y = ex->y;
+            rect->width = info->width;
+            rect->height = info->height;
+
+            if (rect->x > mapWidth && rect->x <= WORD_MAX) {
+                rect->width = rect->x + rect->width;
+                rect->x = 0;
+            }
+
+            AddToExplosionBox(rect);
+        }
+
         StartSound(SND_EXPLOSION);
 
         break;
@@ -6394,11 +6784,14 @@ void NewExplosion(word x, word y)
 
 /*
 Animate one frame for each active explosion, expiring old ones in the process.
+The explosion bounding box is rebuilt from the ones that are still alive.
 */
 void DrawExplosions(void)
 {
     word i;
 
+    ClearExplosionBox();
+
     for (i = 0; i < numExplosions; i++) {
         Explosion *ex = (Explosion *) explosions[i];
 
@@ -6428,25 +6821,48 @@ void DrawExplosions(void)
         if (ex->age == 9) {
             ex->age = 0;
             NewDecoration(SPR_SMOKE_LARGE, 6, ex->x + 1, ex->y - 1, DIR8_NORTH, 1);
+        } else {
+            AddToExplosionBox(explosionRects + i);
         }
     }
 }
 
 /*
 Return true if *any* explosion is touching the specified sprite.
+
+Sprites entirely outside the explosion bounding box are turned away before the
+sprite frame is even looked up, which is the case nearly every time.
 */
 bool IsNearExplosion(word sprite, word frame, word x, word y)
 {
     word i;
+    register word width, height;
+    SpriteFrame *info;
+
+    if (x >= explosionBoxRight || y < explosionBoxTop) return false;
+
+    info = SPRITE_FRAME(sprite, frame);
+    height = info->height;
+    width = info->width;
+
+    if (x + width <= explosionBoxLeft || y >= explosionBoxBottom + height - 1) {
+        return false;
+    }
 
     for (i = 0; i < numExplosions; i++) {
-        Explosion *ex;
+        ExplosionRect *rect;
 
         if (*explosions[i] == 0) continue;
 
-        ex = (Explosion *) explosions[i];
+        rect = explosionRects + i;
 
-        if (IsIntersecting(SPR_EXPLOSION, 0, ex->x, ex->y, sprite, frame, x, y)) {
+        if ((
+            (x <= rect->x && x + width > rect->x) ||
+            (x >= rect->x && rect->x + rect->width > x)
+        ) && (
+            (rect->y - rect->height < y && y <= rect->y) ||
+            (y - height < rect->y && rect->y <= y)
+        )) {
             return true;
         }
     }
@@ -6591,7 +7007,7 @@ void MoveAndDrawDecorations(void)
 
             if (dec->sprite == SPR_RAINDROP) {
                 dec->x--;
-                dec->y += random(3);
+                dec->y += WORLD_RANDOM(3);
             }
 
             dec->x += dir8X[dec->dir];
@@ -6801,7 +7217,7 @@ void DestroyBarrel(word index)
 {
     Actor *act = actors + index;
 
-    act->dead = true;
+    KILL_ACTOR(act);
 
     NewShard(act->data2, 0, act->x - 1, act->y);
     NewShard(act->data2, 1, act->x + 1, act->y - 1);
@@ -6839,13 +7255,13 @@ bool TouchPlayer(word index, word sprite, word frame, word x, word y)
     Actor *act = actors + index;
     word width;
     register word height;
-    register word offset;
+    SpriteFrame *info;
 
     if (!IsSpriteVisible(sprite, frame, x, y)) return true;
 
-    offset = *(actorInfoData + sprite) + (frame * 4);
-    height = *(actorInfoData + offset);
-    width = *(actorInfoData + offset + 1);
+    info = SPRITE_FRAME(sprite, frame);
+    height = info->height;
+    width = info->width;
 
     isPounceReady = false;
     if (sprite == SPR_BOSS) {
@@ -6892,7 +7308,7 @@ bool TouchPlayer(word index, word sprite, word frame, word x, word y)
             nextDrawMode = DRAWMODE_WHITE;
             act->data1--;
             if (act->data1 == 0) {
-                act->dead = true;
+                KILL_ACTOR(act);
                 AddScoreForSprite(SPR_CABBAGE);
                 NewPounceDecoration(act->x, act->y);
                 return true;
@@ -6920,7 +7336,7 @@ bool TouchPlayer(word index, word sprite, word frame, word x, word y)
             act->data5--;
             nextDrawMode = DRAWMODE_WHITE;
             if (act->data5 == 0) {
-                act->dead = true;
+                KILL_ACTOR(act);
                 if (sprite == SPR_GHOST) {
                     NewActor(ACT_BABY_GHOST, act->x, act->y);
                 }
@@ -6938,7 +7354,7 @@ bool TouchPlayer(word index, word sprite, word frame, word x, word y)
     case SPR_BIRD:
         if (act->damagecooldown == 0 && PounceHelper(7)) {
             StartSound(SND_PLAYER_POUNCE);
-            act->dead = true;
+            KILL_ACTOR(act);
             NewPounceDecoration(act->x, act->y);
             AddScoreForSprite(act->sprite);
             return true;
@@ -6970,7 +7386,7 @@ bool TouchPlayer(word index, word sprite, word frame, word x, word y)
             }
             if (act->data5 == 0) {
                 NewPounceDecoration(act->x, act->y);
-                act->dead = true;
+                KILL_ACTOR(act);
                 if (act->data1 > 0) {
                     AddScore(3200);
                     NewActor(ACT_SCORE_EFFECT_3200, act->x, act->y);
@@ -7003,7 +7419,7 @@ bool TouchPlayer(word index, word sprite, word frame, word x, word y)
             if (act->data5 == 0) {
                 NewActor(ACT_STAR_FLOAT, act->x, act->y);
                 NewPounceDecoration(act->x, act->y);
-                act->dead = true;
+                KILL_ACTOR(act);
                 return true;
             }
             nextDrawMode = DRAWMODE_WHITE;
@@ -7023,7 +7439,7 @@ bool TouchPlayer(word index, word sprite, word frame, word x, word y)
                 act->data5--;
             }
             if (act->data5 == 0 || sprite == SPR_RED_CHOMPER) {
-                act->dead = true;
+                KILL_ACTOR(act);
                 AddScoreForSprite(act->sprite);
                 NewPounceDecoration(act->x, act->y);
                 return true;
@@ -7038,7 +7454,7 @@ bool TouchPlayer(word index, word sprite, word frame, word x, word y)
             AddScoreForSprite(SPR_PINK_WORM);
             StartSound(SND_PLAYER_POUNCE);
             NewPounceDecoration(act->x, act->y);
-            act->dead = true;
+            KILL_ACTOR(act);
             NewActor(ACT_PINK_WORM_SLIME, act->x, act->y);
             return true;
         }
@@ -7160,7 +7576,7 @@ bool TouchPlayer(word index, word sprite, word frame, word x, word y)
     case SPR_STAR:
         NewDecoration(SPR_SPARKLE_LONG, 8, x, y, DIR8_STATIONARY, 1);
         gameStars++;
-        act->dead = true;
+        KILL_ACTOR(act);
         StartSound(SND_BIG_PRIZE);
         AddScoreForSprite(sprite);
         NewActor(ACT_SCORE_EFFECT_200, x, y);
@@ -7187,7 +7603,7 @@ bool TouchPlayer(word index, word sprite, word frame, word x, word y)
     case SPR_50:  /* " " " ACT_PYRAMID_FLOOR " " " */
         HurtPlayer();
         if (act->sprite == SPR_PROJECTILE) {
-            act->dead = true;
+            KILL_ACTOR(act);
         }
         return false;
 
@@ -7242,7 +7658,7 @@ bool TouchPlayer(word index, word sprite, word frame, word x, word y)
         return false;
 
     case SPR_POWER_UP:
-        act->dead = true;
+        KILL_ACTOR(act);
         StartSound(SND_BIG_PRIZE);
         NewDecoration(SPR_SPARKLE_SHORT, 4, act->x, act->y, DIR8_STATIONARY, 3);
         if (!sawHealthHint) {
@@ -7264,7 +7680,7 @@ bool TouchPlayer(word index, word sprite, word frame, word x, word y)
     case SPR_RED_TOMATO:
     case SPR_YEL_PEAR:
     case SPR_ONION:
-        act->dead = true;
+        KILL_ACTOR(act);
         AddScore(200);
         NewActor(ACT_SCORE_EFFECT_200, x, y);
         NewDecoration(SPR_SPARKLE_SHORT, 4, act->x, act->y, DIR8_STATIONARY, 3);
@@ -7290,7 +7706,7 @@ bool TouchPlayer(word index, word sprite, word frame, word x, word y)
     case SPR_RED_LEAFY:
     case SPR_BRN_PEAR:
     case SPR_CANDY_CORN:
-        act->dead = true;
+        KILL_ACTOR(act);
         if (
             sprite == SPR_YEL_FRUIT_VINE || sprite == SPR_BANANAS ||
             sprite == SPR_GRAPES || sprite == SPR_RED_BERRIES
@@ -7306,7 +7722,7 @@ bool TouchPlayer(word index, word sprite, word frame, word x, word y)
         return true;
 
     case SPR_HAMBURGER:
-        act->dead = true;
+        KILL_ACTOR(act);
         AddScore(12800);
         NewActor(SPR_SCORE_EFFECT_12800, x, y);
         NewDecoration(SPR_SPARKLE_SHORT, 4, act->x, act->y, DIR8_STATIONARY, 3);
@@ -7330,7 +7746,7 @@ bool TouchPlayer(word index, word sprite, word frame, word x, word y)
 
     case SPR_BOMB_IDLE:
         if (playerBombs <= 8) {
-            act->dead = true;
+            KILL_ACTOR(act);
             playerBombs++;
             sawBombHint = true;
             AddScore(100);
@@ -7374,7 +7790,7 @@ bool TouchPlayer(word index, word sprite, word frame, word x, word y)
                 nextDrawMode = DRAWMODE_WHITE;
                 act->data2--;
                 if (act->data2 == 0) {
-                    act->dead = true;
+                    KILL_ACTOR(act);
                     NewPounceDecoration(act->x - 1, act->y + 1);
                 }
             }
@@ -7490,7 +7906,7 @@ bool TouchPlayer(word index, word sprite, word frame, word x, word y)
     case SPR_ROTATING_ORNAMENT:
     case SPR_GRN_EMERALD:
     case SPR_CLR_DIAMOND:
-        act->dead = true;
+        KILL_ACTOR(act);
         NewDecoration(SPR_SPARKLE_SHORT, 4, act->x, act->y, DIR8_STATIONARY, 3);
         AddScore(3200);
         NewActor(ACT_SCORE_EFFECT_3200, x, y);
@@ -7499,7 +7915,7 @@ bool TouchPlayer(word index, word sprite, word frame, word x, word y)
 
     case SPR_BLU_CRYSTAL:
     case SPR_RED_CRYSTAL:
-        act->dead = true;
+        KILL_ACTOR(act);
         NewDecoration(SPR_SPARKLE_SHORT, 4, act->x, act->y, DIR8_STATIONARY, 3);
         AddScore(1600);
         NewActor(ACT_SCORE_EFFECT_1600, x, y);
@@ -7511,7 +7927,7 @@ bool TouchPlayer(word index, word sprite, word frame, word x, word y)
     case SPR_GRY_OCTAHEDRON:
     case SPR_BLU_EMERALD:
     case SPR_HEADPHONES:
-        act->dead = true;
+        KILL_ACTOR(act);
         NewDecoration(SPR_SPARKLE_SHORT, 4, act->x, act->y, DIR8_STATIONARY, 3);
         AddScore(800);
         NewActor(ACT_SCORE_EFFECT_800, x, y);
@@ -7544,7 +7960,7 @@ bool TouchPlayer(word index, word sprite, word frame, word x, word y)
         return false;
 
     case SPR_INVINCIBILITY_CUBE:
-        act->dead = true;
+        KILL_ACTOR(act);
         NewActor(ACT_INVINCIBILITY_BUBB, playerX - 1, playerY + 1);
         NewDecoration(SPR_SPARKLE_LONG, 8, x, y, DIR8_STATIONARY, 1);
         /* BUG: score effect is spawned, but no score given */
@@ -7615,10 +8031,13 @@ void ProcessActor(word index)
 {
     Actor *act = actors + index;
 
-    if (act->dead) return;
+    if (act->dead) {
+        SleepActor(index);
+        return;
+    }
 
     if (act->y > mapHeight + SCROLLH + 3) {
-        act->dead = true;
+        KILL_ACTOR(act);
         return;
     }
 
@@ -7631,6 +8050,8 @@ void ProcessActor(word index)
             act->forceactive = true;
         }
     } else if (!act->forceactive) {
+        /* Nothing left to count down; leave it be until it's scrolled into view */
+        if (act->damagecooldown == 0) SleepActor(index);
         return;
     } else {
         nextDrawMode = DRAWMODE_HIDDEN;
@@ -7671,7 +8092,7 @@ void ProcessActor(word index)
         IsNearExplosion(act->sprite, act->frame, act->x, act->y) &&
         CanBeExploded(act->sprite, act->frame, act->x, act->y)
     ) {
-        act->dead = true;
+        KILL_ACTOR(act);
     } else if (
         !TouchPlayer(index, act->sprite, act->frame, act->x, act->y) &&
         nextDrawMode != DRAWMODE_HIDDEN
@@ -7681,16 +8102,39 @@ void ProcessActor(word index)
 }
 
 /*
-Reset per-frame global actor variables, and process each actor in turn.
+Reset per-frame global actor variables, and process each awake actor in turn.
+
+An actor can move the screen (e.g. a transporter), and any actor that comes into
+view that way must still be processed this frame if it comes later in the actor
+list, so the sleeping actors are checked again whenever the scroll position
+changes.
 */
 void MoveAndDrawActors(void)
 {
     word i;
+    word lastscrollx, lastscrolly;
 
     isPlayerNearHintGlobe = false;
 
+    WakeVisibleActors();
+    lastscrollx = scrollX;
+    lastscrolly = scrollY;
+
     for (i = 0; i < numActors; i++) {
+        if (awakeActors[i >> 3] == 0) {
+            i |= 7;  /* nobody awake in this group of eight */
+            continue;
+        }
+
+        if ((awakeActors[i >> 3] & (1 << (i & 7))) == 0) continue;
+
         ProcessActor(i);
+
+        if (scrollX != lastscrollx || scrollY != lastscrolly) {
+            WakeVisibleActors();
+            lastscrollx = scrollX;
+            lastscrolly = scrollY;
+        }
     }
 
     if (mysteryWallTime != 0) mysteryWallTime = 0;
@@ -7820,6 +8264,25 @@ void DrawFullscreenText(char *entry_name)
     printf("\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n");  /* 22 of these */
 }
 
+/*
+Put the machine back the way DOS expects it, without any of the fanfare of
+ExitClean(): stop the music, restore the keyboard interrupt handler and text
+mode, and shut down the AdLib. For the command-line tools that print a report
+before exiting.
+*/
+void RestoreTextMode(void)
+{
+    StopMusic();
+
+    disable();
+    setvect(9, savedInt9);
+    enable();
+
+    textmode(C80);
+
+    StopAdLib();
+}
+
 /*
 Exit the program cleanly.
 
@@ -7857,10 +8320,11 @@ Read the tile attribute data into the designated memory location.
 */
 void LoadTileAttributeData(char *entry_name)
 {
-    FILE *fp = GroupEntryFp(entry_name);
+    GroupView view;
 
-    fread(tileAttributeData, 7000, 1, fp);
-    fclose(fp);
+    GroupEntryView(entry_name, &view);
+    ReadGroupView(&view, tileAttributeData, 7000);
+    CloseGroupView(&view);
 }
 
 /*
@@ -7868,10 +8332,11 @@ Read the masked tile data into the designated memory location.
 */
 void LoadMaskedTileData(char *entry_name)
 {
-    FILE *fp = GroupEntryFp(entry_name);
+    GroupView view;
 
-    fread(maskedTileData, 40000U, 1, fp);
-    fclose(fp);
+    GroupEntryView(entry_name, &view);
+    ReadGroupView(&view, maskedTileData, 40000U);
+    CloseGroupView(&view);
 }
 
 /*
@@ -7886,10 +8351,12 @@ KiB depending on the episode, which is already decucted from the amount reported
 by coreleft() here.
 
 The memory test in this function checks for the *additional* amount that will be
-dynamically allocated during Startup(). There will be up to fifteen total calls
-to malloc(), requesting a maximum total of 389,883 bytes of memory. Each
+dynamically allocated during Startup(). There will be up to seventeen total
+calls to malloc(), requesting a maximum total of 439,042 bytes of memory. Each
 separate call for `malloc(bytes)` really subtracts `((bytes + 0x17) >> 4) << 4`
-from what's reported by coreleft(), so the final amount ends up being 390,080.
+from what's reported by coreleft(), so the final amount ends up being 439,264.
+(The optional prefetch buffer is not counted; it's only allocated if there is
+memory left over.)
 
 NOTE: This function assumes the video mode has already been set to Dh.
 */
@@ -7912,8 +8379,9 @@ void ValidateSystem(void)
 
     if (
         /* Empirically, real usage values are 383,072 and 7,008. */
-        ( isAdLibPresent && bytesfree < 383792L + 7000) ||
-        (!isAdLibPresent && bytesfree < 383792L)
+        /* The map attribute layer and collision planes need 49,184 more. */
+        ( isAdLibPresent && bytesfree < 383792L + 49184L + 7000) ||
+        (!isAdLibPresent && bytesfree < 383792L + 49184L)
     ) {
         StopAdLib();
         textmode(C80);
@@ -7923,9 +8391,10 @@ void ValidateSystem(void)
 }
 
 /*
-Start with a bang. Set video mode, initialize the AdLib, install the keyboard
-service, initialize the PC speaker state, allocate enough memory, then show the
-pre-title image.
+Start with a bang. Set video mode, read the group file directories, open the
+cooked asset bundle (if there is a current one) and the backdrop cache,
+initialize the AdLib, install the keyboard service, initialize the PC speaker
+state, allocate enough memory, then show the pre-title image.
 
 While the pre-title image is up, load the config file, then allocate and
 generate/load a whole slew of data to each arena. This takes a noticable amount
@@ -7943,6 +8412,10 @@ void Startup(void)
     */
     SetVideoMode(0x0d);
 
+    LoadGroupDirectory();
+    OpenCookedBundle();
+    OpenBackdropCache(JoinPath(writePath, FILENAME_BASE ".BDC"));
+
     StartAdLib();
 
     ValidateSystem();
@@ -7961,6 +8434,8 @@ void Startup(void)
 
     enable();
 
+    ResetWorld();
+
     miscData = malloc(35000U);
 
     DrawFullscreenImage(IMAGE_PRETITLE);
@@ -7986,6 +8461,13 @@ void Startup(void)
     playerTileData = malloc((word)GroupEntryLength("PLAYERS.MNI"));
 
     mapData.b = malloc(WORD_MAX);
+    mapAttributeData = malloc(WORD_MAX / 2);
+
+    /* Four collision planes, each with one bit per map cell plus a spare word */
+    northPlane = malloc(COLLISION_PLANE_SIZE * 4);
+    southPlane = northPlane + (COLLISION_PLANE_SIZE / 2);
+    westPlane = southPlane + (COLLISION_PLANE_SIZE / 2);
+    eastPlane = westPlane + (COLLISION_PLANE_SIZE / 2);
 
     /*
     16-bit nightmare here. Each actor data chunk is limited to 65,535 bytes,
@@ -7998,11 +8480,19 @@ void Startup(void)
     actorTileData[1] = malloc(WORD_MAX);
     actorTileData[2] = malloc((word)GroupEntryLength("ACTORS.MNI") + 2);
 
-    LoadGroupEntryData("STATUS.MNI", actorTileData[0], 7296);
-    CopyTilesToEGA(actorTileData[0], 7296 / 4, 0x8000);
+    if (ReadCookedAsset(COOKED_STATUS, actorTileData[0], 7296)) {
+        CopyPlanesToEGA(actorTileData[0], 7296 / 4, 0x8000);
+    } else {
+        LoadGroupEntryData("STATUS.MNI", actorTileData[0], 7296);
+        CopyTilesToEGA(actorTileData[0], 7296 / 4, 0x8000);
+    }
 
-    LoadGroupEntryData("TILES.MNI", actorTileData[0], 64000U);
-    CopyTilesToEGA(actorTileData[0], 64000U / 4, 0x4000);
+    if (ReadCookedAsset(COOKED_TILES, actorTileData[0], 64000U)) {
+        CopyPlanesToEGA(actorTileData[0], 64000U / 4, 0x4000);
+    } else {
+        LoadGroupEntryData("TILES.MNI", actorTileData[0], 64000U);
+        CopyTilesToEGA(actorTileData[0], 64000U / 4, 0x4000);
+    }
 
     LoadActorTileData("ACTORS.MNI");
 
@@ -8010,6 +8500,7 @@ void Startup(void)
 
     actorInfoData = malloc((word)GroupEntryLength("ACTRINFO.MNI"));
     LoadInfoData("ACTRINFO.MNI", actorInfoData, (word)GroupEntryLength("ACTRINFO.MNI"));
+    BuildSpriteFrames((word)GroupEntryLength("ACTRINFO.MNI"));
 
     playerInfoData = malloc((word)GroupEntryLength("PLYRINFO.MNI"));
     LoadInfoData("PLYRINFO.MNI", playerInfoData, (word)GroupEntryLength("PLYRINFO.MNI"));
@@ -8025,6 +8516,11 @@ void Startup(void)
         LoadTileAttributeData("TILEATTR.MNI");
     }
 
+    /* Optional; only used if there is memory to spare after everything else. */
+    if (coreleft() > (dword)PREFETCH_BUFFER_SIZE + PREFETCH_HEADROOM) {
+        InitializePrefetch(malloc(PREFETCH_BUFFER_SIZE), PREFETCH_BUFFER_SIZE);
+    }
+
     totalMemFreeAfter = coreleft();
 
     ClearScreen();
@@ -8158,10 +8654,7 @@ This is the hairiest function in the entire game. Best of luck to you.
 */
 void MovePlayer(void)
 {
-    static word idlecount = 0;
     static int jumptable[] = {-2, -1, -1, -1, -1, -1, -1, 0, 0, 0};
-    static word movecount = 0;
-    static word bombcooldown = 0;
     word horizmove;
     register word southmove = 0;
     register bool clingslip = false;
@@ -8173,7 +8666,7 @@ void MovePlayer(void)
         playerDizzyLeft != 0 || blockActionCmds
     ) return;
 
-    movecount++;
+    playerMoveCount++;
 
     MovePlayerPush();
 
@@ -8216,16 +8709,16 @@ void MovePlayer(void)
 
     if (playerClingDir == DIR4_NONE) {
         if (!cmdBomb) {
-            bombcooldown = 0;
+            playerBombCooldown = 0;
         }
 
-        if (cmdBomb && bombcooldown == 0) {
-            bombcooldown = 2;
+        if (cmdBomb && playerBombCooldown == 0) {
+            playerBombCooldown = 2;
         }
 
-        if (bombcooldown != 0 && bombcooldown != 1) {
-            bombcooldown--;
-            if (bombcooldown == 1) {
+        if (playerBombCooldown != 0 && playerBombCooldown != 1) {
+            playerBombCooldown--;
+            if (playerBombCooldown == 1) {
                 bool nearblocked, farblocked;
                 if (playerBaseFrame == PLAYER_BASE_WEST) {
                     nearblocked = TILE_BLOCK_WEST(GetMapTile(playerX - 1, playerY - 2));
@@ -8543,10 +9036,10 @@ void MovePlayer(void)
     }
 
     if (playerBombDir != DIR4_NONE) {
-        idlecount = 0;
+        playerIdleCount = 0;
         playerFrame = PLAYER_CROUCH;
     } else if ((cmdNorth || cmdSouth) && !cmdWest && !cmdEast && !isPlayerFalling && !cmdJump) {
-        idlecount = 0;
+        playerIdleCount = 0;
         if (cmdNorth && !isPlayerNearTransporter && !isPlayerNearHintGlobe) {
             if (scrollY > 0 && playerY - scrollY < SCROLLH - 1) {
                 scrollY--;
@@ -8574,21 +9067,21 @@ void MovePlayer(void)
         }
         return;
     } else if (playerClingDir == DIR4_WEST) {
-        idlecount = 0;
+        playerIdleCount = 0;
         if (cmdEast) {
             playerFrame = PLAYER_CLING_OPPOSITE;
         } else {
             playerFrame = PLAYER_CLING;
         }
     } else if (playerClingDir == DIR4_EAST) {
-        idlecount = 0;
+        playerIdleCount = 0;
         if (cmdWest) {
             playerFrame = PLAYER_CLING_OPPOSITE;
         } else {
             playerFrame = PLAYER_CLING;
         }
     } else if ((isPlayerFalling && !isPlayerRecoiling) || (playerJumpTime > 6 && !isPlayerFalling)) {
-        idlecount = 0;
+        playerIdleCount = 0;
         if (!isPlayerRecoiling && !isPlayerFalling && playerJumpTime > 6) {
             playerFrame = PLAYER_FALL;
         } else if (playerFallTime >= 10 && playerFallTime < 25) {
@@ -8602,7 +9095,7 @@ void MovePlayer(void)
             playerFrame = PLAYER_FALL;
         }
     } else if ((cmdJump && !cmdJumpLatch) || isPlayerRecoiling) {
-        idlecount = 0;
+        playerIdleCount = 0;
         playerFrame = PLAYER_JUMP;
         if (isPlayerRecoiling && isPlayerLongJumping) {
             playerFrame = PLAYER_JUMP_LONG;
@@ -8611,26 +9104,26 @@ void MovePlayer(void)
             playerFrame = PLAYER_FALL;
         }
     } else if (cmdWest == cmdEast) {
-        byte rnd = random(50);
+        byte rnd = WORLD_RANDOM(50);
         playerFrame = PLAYER_STAND;
         if (!cmdWest && !cmdEast && !isPlayerFalling) {
-            idlecount++;
-            if (idlecount > 100 && idlecount < 110) {
+            playerIdleCount++;
+            if (playerIdleCount > 100 && playerIdleCount < 110) {
                 playerFrame = PLAYER_LOOK_NORTH;
-            } else if (idlecount > 139 && idlecount < 150) {
+            } else if (playerIdleCount > 139 && playerIdleCount < 150) {
                 playerFrame = PLAYER_LOOK_SOUTH;
-            } else if (idlecount == 180) {
+            } else if (playerIdleCount == 180) {
                 playerFrame = PLAYER_SHAKE_1;
-            } else if (idlecount == 181) {
+            } else if (playerIdleCount == 181) {
                 playerFrame = PLAYER_SHAKE_2;
-            } else if (idlecount == 182) {
+            } else if (playerIdleCount == 182) {
                 playerFrame = PLAYER_SHAKE_3;
-            } else if (idlecount == 183) {
+            } else if (playerIdleCount == 183) {
                 playerFrame = PLAYER_SHAKE_2;
-            } else if (idlecount == 184) {
+            } else if (playerIdleCount == 184) {
                 playerFrame = PLAYER_SHAKE_1;
-            } else if (idlecount == 185) {
-                idlecount = 0;
+            } else if (playerIdleCount == 185) {
+                playerIdleCount = 0;
             }
         }
         if (
@@ -8641,8 +9134,8 @@ void MovePlayer(void)
             playerFrame = PLAYER_STAND_BLINK;
         }
     } else if (!isPlayerFalling) {
-        idlecount = 0;
-        if (movecount % 2 != 0) {
+        playerIdleCount = 0;
+        if (playerMoveCount % 2 != 0) {
             if (playerFrame % 2 != 0) {
                 StartSound(SND_PLAYER_FOOTSTEP);
             }
@@ -8675,8 +9168,6 @@ Handle player movement and bomb placement while the player is riding a scooter.
 */
 void MovePlayerScooter(void)
 {
-    static word bombcooldown = 0;
-
     ClearPlayerDizzy();
 
     isPounceReady = false;
@@ -8773,20 +9264,20 @@ void MovePlayerScooter(void)
     }
 
     if (!cmdBomb) {
-        bombcooldown = 0;
+        scooterBombCooldown = 0;
     }
 
-    if (cmdBomb && bombcooldown == 0) {
-        bombcooldown = 1;
+    if (cmdBomb && scooterBombCooldown == 0) {
+        scooterBombCooldown = 1;
         playerFrame = PLAYER_CROUCH;
     }
 
-    if (bombcooldown != 0 && bombcooldown != 2) {
+    if (scooterBombCooldown != 0 && scooterBombCooldown != 2) {
         playerFrame = PLAYER_CROUCH;
 
-        if (bombcooldown != 0) {  /* redundant; outer condition makes this always true */
+        if (scooterBombCooldown != 0) {  /* redundant; outer condition makes this always true */
             register bool nearblocked, farblocked;
-            bombcooldown = 2;
+            scooterBombCooldown = 2;
 
             if (playerBaseFrame == PLAYER_BASE_WEST) {
                 nearblocked = TILE_BLOCK_WEST(GetMapTile(playerX - 1, playerY - 2));
@@ -9040,6 +9531,11 @@ bbool LoadGameState(char slot_char)
     FILE *fp;
     word checksum;
 
+    if (slot_char == 'T' && isRestartStale) {
+        WriteSaveRecord('T', restartRecord);
+        isRestartStale = false;
+    }
+
     *(filename + SAVE_SLOT_INDEX) = slot_char;
 
     fp = fopen(JoinPath(writePath, filename), "rb");
@@ -9102,92 +9598,403 @@ void SaveGameState(char slot_char)
 }
 
 /*
-Present a UI for restoring a saved game, and return the result of the prompt.
+Read the raw contents of a save file into `record`, which must hold at least
+SAVE_RECORD_SIZE bytes. The slot character is as in SaveGameState(). If the file
+can't be read, the record is zeroed.
 */
-byte PromptRestoreGame(void)
+void ReadSaveRecord(char slot_char, byte *record)
 {
-    word x;
-    byte lastkey;
+    static char *filename = FILENAME_BASE ".SV ";
+    FILE *fp;
 
-    x = UnfoldTextFrame(11, 7, 28, "Restore a game.", "Press ESC to quit.");
-    DrawTextLine(x, 14, " What game number (1-9)?");
-    lastkey = WaitSpinner(x + 24, 14);
+    *(filename + SAVE_SLOT_INDEX) = slot_char;
 
-    if (lastkey == SCANCODE_ESC || lastkey == SCANCODE_SPACE || lastkey == SCANCODE_ENTER) {
-        /* VOID */
+    memset(record, 0, SAVE_RECORD_SIZE);
 
-    } else if (lastkey >= SCANCODE_1 && lastkey < SCANCODE_0) {
-        DrawScancodeCharacter(x + 24, 14, lastkey);
+    fp = fopen(JoinPath(writePath, filename), "rb");
+    if (fp == NULL) return;
 
-        if (!LoadGameState(lastkey + 47)) {
-            return RESTORE_GAME_NOT_FOUND;
-        } else {
-            return RESTORE_GAME_SUCCESS;
-        }
-    } else {
-        x = UnfoldTextFrame(11, 4, 28, "Invalid game number!", "Press ANY key.");
-        WaitSpinner(x + 25, 13);
+    fread(record, 1, SAVE_RECORD_SIZE, fp);
+    fclose(fp);
+}
+
+/*
+Write a record read by ReadSaveRecord() back out as a save file.
+*/
+void WriteSaveRecord(char slot_char, byte *record)
+{
+    static char *filename = FILENAME_BASE ".SV ";
+    FILE *fp;
+
+    *(filename + SAVE_SLOT_INDEX) = slot_char;
+
+    fp = fopen(JoinPath(writePath, filename), "wb");
+    if (fp == NULL) return;
+
+    fwrite(record, 1, SAVE_RECORD_SIZE, fp);
+    fclose(fp);
+}
+
+/*
+Allocate the map buffers of a world snapshot. Returns false, with nothing left
+allocated, if there isn't enough memory for all of them.
+*/
+bool NewWorldSnapshot(WorldSnapshot *snap)
+{
+    snap->map = malloc(WORD_MAX);
+    snap->attributes = malloc(WORD_MAX / 2);
+    snap->planes = malloc(COLLISION_PLANE_SIZE * 4);
+
+    if (snap->map == NULL || snap->attributes == NULL || snap->planes == NULL) {
+        FreeWorldSnapshot(snap);
+
+        return false;
     }
 
-    return RESTORE_GAME_ABORT;
+    return true;
 }
 
 /*
-Present a UI for saving the game. As the prompt says, the save file will be
-written with the state of the game when the level was last started.
+Release the map buffers of a world snapshot.
 */
-void PromptSaveGame(void)
+void FreeWorldSnapshot(WorldSnapshot *snap)
 {
-    word x;
-    byte lastkey;
-    word tmphealth, tmpbombs, tmplevel, tmpstars, tmpbars;
-    dword tmpscore;
+    if (snap->map != NULL) free(snap->map);
+    if (snap->attributes != NULL) free(snap->attributes);
+    if (snap->planes != NULL) free(snap->planes);
 
-    x = UnfoldTextFrame(8, 10, 28, "Save a game.", "Press ESC to quit.");
-    DrawTextLine(x, 11, " What game number (1-9)?");
-    DrawTextLine(x, 13, " NOTE: Game is saved at");
-    DrawTextLine(x, 14, " BEGINNING of level.");
-    lastkey = WaitSpinner(x + 24, 11);
+    snap->map = snap->attributes = NULL;
+    snap->planes = NULL;
+}
 
-    if (lastkey == SCANCODE_ESC || lastkey == SCANCODE_SPACE || lastkey == SCANCODE_ENTER) {
-        /* VOID */
+/*
+Point the world's map, attribute layer, and collision planes at the passed heap
+buffers. Needed whenever the World struct is overwritten wholesale, since the
+pointers in the source are no good.
+*/
+void SetWorldBuffers(byte *map, byte *attributes, word *planes)
+{
+    mapData.b = map;
+    mapAttributeData = attributes;
+    northPlane = planes;
+    southPlane = northPlane + (COLLISION_PLANE_SIZE / 2);
+    westPlane = southPlane + (COLLISION_PLANE_SIZE / 2);
+    eastPlane = westPlane + (COLLISION_PLANE_SIZE / 2);
+}
 
-    } else if (lastkey >= SCANCODE_1 && lastkey < SCANCODE_0) {
-        DrawScancodeCharacter(x + 24, 11, lastkey);
+/*
+Copy the entire state of the game world into the passed snapshot, which must
+have been set up by NewWorldSnapshot(). Unlike SaveGameState(), this captures
+everything down to the last actor and map tile, so RestoreWorld() continues the
+game from exactly this frame. The temporary save file that the level restarts
+from is captured too, since finishing a level overwrites it.
+*/
+void SnapshotWorld(WorldSnapshot *snap)
+{
+    snap->world = world;
+    snap->paletteStepCount = paletteStepCount;
+    memcpy(snap->restart, restartRecord, SAVE_RECORD_SIZE);
 
-        tmphealth = playerHealth;
-        tmpbombs = playerBombs;
-        tmpstars = (word)gameStars;
-        tmplevel = levelNum;
-        tmpbars = playerMaxHealth;
-        tmpscore = gameScore;
+    movmem(mapData.b, snap->map, WORD_MAX);
+    movmem(mapAttributeData, snap->attributes, WORD_MAX / 2);
+    movmem(northPlane, snap->planes, COLLISION_PLANE_SIZE * 4);
+}
 
-        LoadGameState('T');
-        SaveGameState(lastkey + 47);
+/*
+Put the game world back into the state captured by SnapshotWorld(). The world
+keeps its own map buffers; only their contents are replaced.
 
-        playerHealth = tmphealth;
-        playerBombs = tmpbombs;
-        gameStars = tmpstars;
-        levelNum = tmplevel;
-        gameScore = tmpscore;
-        playerMaxHealth = tmpbars;
+Both video pages are invalidated, since the map they show may have nothing to do
+with the one that's been restored. Level assets (backdrop, music, tile graphics)
+are not part of the world, so a snapshot must be restored on the level it was
+taken on.
+*/
+void RestoreWorld(WorldSnapshot *snap)
+{
+    byte *map = mapData.b;
+    byte *attributes = mapAttributeData;
+    word *planes = northPlane;
 
-        x = UnfoldTextFrame(7, 4, 20, "Game Saved.", "Press ANY key.");
-        WaitSpinner(x + 17, 9);
-    } else {
-        x = UnfoldTextFrame(11, 4, 28, "Invalid game number!", "Press ANY key.");
-        WaitSpinner(x + 25, 13);
+    world = snap->world;
+    paletteStepCount = snap->paletteStepCount;
+    SetWorldBuffers(map, attributes, planes);
+
+    if (memcmp(restartRecord, snap->restart, SAVE_RECORD_SIZE) != 0) {
+        memcpy(restartRecord, snap->restart, SAVE_RECORD_SIZE);
+        isRestartStale = true;
     }
+
+    movmem(snap->map, mapData.b, WORD_MAX);
+    movmem(snap->attributes, mapAttributeData, WORD_MAX / 2);
+    movmem(snap->planes, northPlane, COLLISION_PLANE_SIZE * 4);
+
+    InvalidateMapRegion();
 }
 
 /*
-Present a UI for the "warp mode" debug feature. This abandons any progress made
-in the current level, and jumps unconditionally to the new level. Returns true
-if the request was acceptable, or false if the input was bad or Esc was pressed.
+Write the temporary save file (the state the level restarts from if the player
+dies), the world, the palette step counter, and a {cell, tile} pair for every
+map cell that differs from the level's map file to the passed file, folding all
+of it into the CRC pointed to by `crc`. The `pristine` buffer must hold at least
+WORLD_SAVE_CHUNK bytes. Returns the number of {cell, tile} pairs written.
 */
-bbool PromptLevelWarp(void)
+word WriteWorldState(FILE *fp, word *pristine, word *crc)
 {
-    word levels[] = {
+    GroupView view;
+    word cell, i, count;
+    word delta[2];
+    word numdeltas = 0;
+
+    fwrite(restartRecord, 1, SAVE_RECORD_SIZE, fp);
+    *crc = UpdateCRC16(*crc, restartRecord, SAVE_RECORD_SIZE);
+
+    fwrite(&world, sizeof(World), 1, fp);
+    *crc = UpdateCRC16(*crc, &world, sizeof(World));
+    fwrite(&paletteStepCount, 4, 1, fp);
+    *crc = UpdateCRC16(*crc, &paletteStepCount, 4);
+
+    /* Skip over the map file's header and actor list to reach the map itself */
+    GroupEntryView(mapNames[levelNum], &view);
+    ReadGroupView(&view, pristine, 6);
+
+    for (count = *(pristine + 2) * 2; count != 0; count -= i) {
+        i = count < WORLD_SAVE_CHUNK ? count : WORLD_SAVE_CHUNK;
+        ReadGroupView(&view, pristine, i);
+    }
+
+    for (cell = 0; cell < WORD_MAX / 2; cell += count) {
+        count = ReadGroupView(&view, pristine, WORLD_SAVE_CHUNK) / 2;
+        if (count == 0) break;
+        if (count > (WORD_MAX / 2) - cell) count = (WORD_MAX / 2) - cell;
+
+        for (i = 0; i < count; i++) {
+            if (*(pristine + i) == *(mapData.w + cell + i)) continue;
+
+            delta[0] = cell + i;
+            delta[1] = *(mapData.w + cell + i);
+            fwrite(delta, 2, 2, fp);
+            *crc = UpdateCRC16(*crc, delta, 4);
+            numdeltas++;
+        }
+    }
+
+    CloseGroupView(&view);
+
+    return numdeltas;
+}
+
+/*
+Save the complete state of the level in progress to a mid-level save file. The
+slot character works the same as in SaveGameState(), but the file is a separate
+one. Of the map, only the cells that differ from the level's map file are
+stored. Returns false if the file could not be written, in which case no file is
+left in the slot.
+*/
+bbool SaveWorldState(char slot_char)
+{
+    static char *filename = FILENAME_BASE ".SW ";
+    WorldSaveHeader header;
+    FILE *fp;
+    word *pristine;
+    bbool ok;
+
+    *(filename + SAVE_SLOT_INDEX) = slot_char;
+
+    pristine = malloc(WORLD_SAVE_CHUNK);
+    if (pristine == NULL) {
+        remove(JoinPath(writePath, filename));
+
+        return false;
+    }
+
+    fp = fopen(JoinPath(writePath, filename), "wb");
+    if (fp == NULL) {
+        free(pristine);
+
+        return false;
+    }
+
+    memcpy(header.magic, WORLD_SAVE_MAGIC, 4);
+    header.version = WORLD_SAVE_VERSION;
+    header.worldsize = sizeof(World);
+    header.codestamp = FP_OFF((void far *)ProcessActor);
+    header.levelnum = levelNum;
+    header.numdeltas = 0;
+    header.crc = CRC16_INITIAL;
+
+    /* Placeholder; rewritten with the final delta count and CRC at the end */
+    fwrite(&header, sizeof(header), 1, fp);
+
+    header.numdeltas = WriteWorldState(fp, pristine, &header.crc);
+    free(pristine);
+
+    header.crc = UpdateCRC16(header.crc, &header, sizeof(header) - sizeof(header.crc));
+
+    fseek(fp, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, fp);
+
+    ok = !ferror(fp);
+    fclose(fp);
+
+    if (!ok) remove(JoinPath(writePath, filename));
+
+    return ok;
+}
+
+/*
+Load a mid-level save file written by SaveWorldState() and resume the level
+exactly where it was saved. Returns false if the file doesn't exist or was
+written by a different build of the game. Like LoadGameState(), exits the game
+if the file has been manipulated.
+
+The level is set up through SwitchLevel(), but its map is read straight from the
+map file without constructing any actors, and the world is then replaced with
+the one in the save file.
+*/
+bbool LoadWorldState(char slot_char)
+{
+    static char *filename = FILENAME_BASE ".SW ";
+    WorldSaveHeader header;
+    FILE *fp;
+    byte *buffer;
+    word length;
+    word crc = CRC16_INITIAL;
+
+    *(filename + SAVE_SLOT_INDEX) = slot_char;
+
+    fp = fopen(JoinPath(writePath, filename), "rb");
+    if (fp == NULL) return false;
+
+    if (
+        fread(&header, sizeof(header), 1, fp) != 1 ||
+        memcmp(header.magic, WORLD_SAVE_MAGIC, 4) != 0 ||
+        header.version != WORLD_SAVE_VERSION ||
+        header.worldsize != sizeof(World) ||
+        header.codestamp != FP_OFF((void far *)ProcessActor) ||
+        (buffer = malloc(WORLD_SAVE_CHUNK)) == NULL
+    ) {
+        fclose(fp);
+
+        return false;
+    }
+
+    while ((length = fread(buffer, 1, WORLD_SAVE_CHUNK, fp)) != 0) {
+        crc = UpdateCRC16(crc, buffer, length);
+    }
+
+    free(buffer);
+
+    crc = UpdateCRC16(crc, &header, sizeof(header) - sizeof(header.crc));
+    if (crc != header.crc) {
+        ShowAlteredFileError();
+        ExitClean();
+    }
+
+    fseek(fp, sizeof(header), SEEK_SET);
+
+    worldStateFp = fp;
+    SwitchLevel(header.levelnum);
+    worldStateFp = NULL;
+
+    fclose(fp);
+
+    return true;
+}
+
+/*
+Present a UI for restoring a saved game, and return the result of the prompt.
+A mid-level save in the chosen slot is preferred over the level-start one.
+*/
+byte PromptRestoreGame(void)
+{
+    word x;
+    byte lastkey;
+
+    x = UnfoldTextFrame(11, 7, 28, "Restore a game.", "Press ESC to quit.");
+    DrawTextLine(x, 14, " What game number (1-9)?");
+    lastkey = WaitSpinner(x + 24, 14);
+
+    if (lastkey == SCANCODE_ESC || lastkey == SCANCODE_SPACE || lastkey == SCANCODE_ENTER) {
+        /* VOID */
+
+    } else if (lastkey >= SCANCODE_1 && lastkey < SCANCODE_0) {
+        DrawScancodeCharacter(x + 24, 14, lastkey);
+
+        if (LoadWorldState(lastkey + 47)) {
+            return RESTORE_GAME_RESUMED;
+        } else if (!LoadGameState(lastkey + 47)) {
+            return RESTORE_GAME_NOT_FOUND;
+        } else {
+            return RESTORE_GAME_SUCCESS;
+        }
+    } else {
+        x = UnfoldTextFrame(11, 4, 28, "Invalid game number!", "Press ANY key.");
+        WaitSpinner(x + 25, 13);
+    }
+
+    return RESTORE_GAME_ABORT;
+}
+
+/*
+Present a UI for saving the game. The save file is written with the state of
+the game when the level was last started, and a mid-level save file with the
+exact current state goes into the same slot next to it.
+*/
+void PromptSaveGame(void)
+{
+    word x;
+    byte lastkey;
+    word tmphealth, tmpbombs, tmplevel, tmpstars, tmpbars;
+    dword tmpscore;
+
+    x = UnfoldTextFrame(8, 10, 28, "Save a game.", "Press ESC to quit.");
+    DrawTextLine(x, 11, " What game number (1-9)?");
+    DrawTextLine(x, 13, " NOTE: Game is saved at");
+    DrawTextLine(x, 14, " CURRENT position.");
+    lastkey = WaitSpinner(x + 24, 11);
+
+    if (lastkey == SCANCODE_ESC || lastkey == SCANCODE_SPACE || lastkey == SCANCODE_ENTER) {
+        /* VOID */
+
+    } else if (lastkey >= SCANCODE_1 && lastkey < SCANCODE_0) {
+        DrawScancodeCharacter(x + 24, 11, lastkey);
+
+        /* Before the level-start stats below overwrite the live ones */
+        SaveWorldState(lastkey + 47);
+
+        tmphealth = playerHealth;
+        tmpbombs = playerBombs;
+        tmpstars = (word)gameStars;
+        tmplevel = levelNum;
+        tmpbars = playerMaxHealth;
+        tmpscore = gameScore;
+
+        LoadGameState('T');
+        SaveGameState(lastkey + 47);
+
+        playerHealth = tmphealth;
+        playerBombs = tmpbombs;
+        gameStars = tmpstars;
+        levelNum = tmplevel;
+        gameScore = tmpscore;
+        playerMaxHealth = tmpbars;
+
+        x = UnfoldTextFrame(7, 4, 20, "Game Saved.", "Press ANY key.");
+        WaitSpinner(x + 17, 9);
+    } else {
+        x = UnfoldTextFrame(11, 4, 28, "Invalid game number!", "Press ANY key.");
+        WaitSpinner(x + 25, 13);
+    }
+}
+
+/*
+Present a UI for the "warp mode" debug feature. This abandons any progress made
+in the current level, and jumps unconditionally to the new level. Returns true
+if the request was acceptable, or false if the input was bad or Esc was pressed.
+*/
+bbool PromptLevelWarp(void)
+{
+    word levels[] = {
         0, 1, 4, 5, 8, 9, 12, 13, 16, 17,
 #ifdef HAS_LEVEL_11
         20,
@@ -9256,6 +10063,8 @@ title:
         }
 
         if (idlecount == 1200) {
+            /* Demos always start from a reset world, as under /VERIFY */
+            ResetWorld();
             InitializeGame();
             return DEMOSTATE_PLAY;
         }
@@ -9300,6 +10109,9 @@ title:
                 result = PromptRestoreGame();
                 if (result == RESTORE_GAME_SUCCESS) {
                     return DEMOSTATE_NONE;
+                } else if (result == RESTORE_GAME_RESUMED) {
+                    isLevelResumed = true;
+                    return DEMOSTATE_NONE;
                 } else if (result == RESTORE_GAME_NOT_FOUND) {
                     ShowRestoreGameError();
                 }
@@ -9309,11 +10121,13 @@ title:
                 goto bigbreak;
             case SCANCODE_F11:
                 if (isDebugMode) {
+                    ResetWorld();
                     InitializeGame();
                     return DEMOSTATE_RECORD;
                 }
                 goto bigbreak;
             case SCANCODE_D:
+                ResetWorld();
                 InitializeGame();
                 return DEMOSTATE_PLAY;
             case SCANCODE_T:
@@ -9380,6 +10194,8 @@ byte ShowGameMenu(void)
             if (result == RESTORE_GAME_SUCCESS) {
                 SwitchLevel(levelNum);
                 return GAME_MENU_RESTART;
+            } else if (result == RESTORE_GAME_RESUMED) {
+                return GAME_MENU_RESTART;
             } else if (result == RESTORE_GAME_NOT_FOUND) {
                 ShowRestoreGameError();
             }
@@ -9399,97 +10215,537 @@ byte ShowGameMenu(void)
 }
 
 /*
-Read the next byte of demo data into the global command variables. Return true
-if the end of the demo data has been reached, otherwise return false.
+Return the next byte from the demo file being played back, refilling the demo
+buffer from the file whenever it runs dry. Past the end of the file, returns
+zero (no input).
+*/
+byte NextDemoByte(void)
+{
+    if (demoBufferPos == demoBufferLength) {
+        demoBufferPos = 0;
+        demoBufferLength = fread(demoBuffer, 1, DEMO_BUFFER_SIZE, demoFp);
+
+        if (demoBufferLength == 0) return 0;
+    }
+
+    return demoBuffer[demoBufferPos++];
+}
+
+/*
+Append a byte to the demo file being recorded, writing the demo buffer out to
+the file whenever it fills up.
+*/
+void PutDemoByte(byte value)
+{
+    demoBuffer[demoBufferPos++] = value;
+
+    if (demoBufferPos == DEMO_BUFFER_SIZE) {
+        fwrite(demoBuffer, 1, DEMO_BUFFER_SIZE, demoFp);
+        demoBufferPos = 0;
+    }
+}
+
+/*
+Return a checksum of the parts of the world that are quickest to go wrong when
+demo playback falls out of step with the recording: the player and scroll
+positions, the random number step counter, and the number of live actors.
+numActors is only a high-water mark, so the live ones are counted from the
+deadActors set instead.
+*/
+word DemoCheckpoint(void)
+{
+    word state[6];
+    word i;
+
+    state[0] = playerX;
+    state[1] = playerY;
+    state[2] = scrollX;
+    state[3] = scrollY;
+    state[4] = randStepCount;
+    state[5] = 0;
+
+    for (i = 0; i < numActors; i++) {
+        if ((deadActors[i >> 3] & (1 << (i & 7))) == 0) state[5]++;
+    }
+
+    return UpdateCRC16(CRC16_INITIAL, state, sizeof(state));
+}
+
+/*
+Unpack one frame's worth of demo input into the global command variables.
+*/
+void UnpackDemoInput(byte input)
+{
+    cmdWest  = (bbool)(input & 0x01);
+    cmdEast  = (bbool)(input & 0x02);
+    cmdNorth = (bbool)(input & 0x04);
+    cmdSouth = (bbool)(input & 0x08);
+    cmdJump  = (bbool)(input & 0x10);
+    cmdBomb  = (bbool)(input & 0x20);
+    winLevel =  (bool)(input & 0x40);
+}
+
+/*
+Read the next frame of demo data into the global command variables. Return true
+if the end of the demo data has been reached, or if the world doesn't match a
+checkpoint recorded in the demo (see demoBadCheckpoint), otherwise return false.
 */
 bbool ReadDemoFrame(void)
 {
-    cmdWest  = (bbool)(*(miscData + demoDataPos) & 0x01);
-    cmdEast  = (bbool)(*(miscData + demoDataPos) & 0x02);
-    cmdNorth = (bbool)(*(miscData + demoDataPos) & 0x04);
-    cmdSouth = (bbool)(*(miscData + demoDataPos) & 0x08);
-    cmdJump  = (bbool)(*(miscData + demoDataPos) & 0x10);
-    cmdBomb  = (bbool)(*(miscData + demoDataPos) & 0x20);
-    winLevel =  (bool)(*(miscData + demoDataPos) & 0x40);
+    byte input;
+    word expected;
 
-    demoDataPos++;
-    if (demoDataPos > demoDataLength) {
-        return true;
+    if (demoFrameCount == 0) return true;
+
+    if (
+        demoVersion >= DEMO_VERSION_CHECKED &&
+        demoFramePos != 0 && demoFramePos % DEMO_CHECK_INTERVAL == 0
+    ) {
+        expected = NextDemoByte();
+        expected |= NextDemoByte() << 8;
+
+        if (expected != DemoCheckpoint()) {
+            demoBadCheckpoint = demoFramePos;
+
+            return true;
+        }
+    }
+
+    demoFrameCount--;
+    demoFramePos++;
+
+    if (demoVersion < DEMO_VERSION_RLE) {
+        input = NextDemoByte();
+    } else {
+        if (demoRunLength == 0) {
+            input = NextDemoByte();
+
+            if ((input & DEMO_RUN_FLAG) != 0) {
+                demoRunLength = (input & ~DEMO_RUN_FLAG) + 1;
+            } else {
+                demoLastInput = input;
+                demoRunLength = 1;
+            }
+        }
+
+        demoRunLength--;
+        input = demoLastInput;
+    }
+
+    UnpackDemoInput(input);
+
+    return false;
+}
+
+/*
+Append one frame's worth of packed input to the demo data. Frames with the same
+input as the previous one are only counted, and written as a run once the input
+changes, the run fills up, or a checkpoint is due. Return true if the demo data
+could not be written, otherwise return false.
+*/
+bbool PutDemoFrame(byte input)
+{
+    word checkpoint;
+
+    if (demoFp == NULL || ferror(demoFp)) return true;
+
+    if (demoFrameCount != 0 && demoFrameCount % DEMO_CHECK_INTERVAL == 0) {
+        if (demoRunLength != 0) {
+            PutDemoByte(DEMO_RUN_FLAG | (demoRunLength - 1));
+            demoRunLength = 0;
+        }
+
+        checkpoint = DemoCheckpoint();
+        PutDemoByte((byte)checkpoint);
+        PutDemoByte(checkpoint >> 8);
+    }
+
+    if (demoFrameCount != 0 && input == demoLastInput && demoRunLength < DEMO_MAX_RUN) {
+        demoRunLength++;
+    } else {
+        if (demoRunLength != 0) {
+            PutDemoByte(DEMO_RUN_FLAG | (demoRunLength - 1));
+        }
+
+        PutDemoByte(input);
+        demoLastInput = input;
+        demoRunLength = 0;
     }
 
+    demoFrameCount++;
+
     return false;
 }
 
 /*
 Pack the current state of all the global command variables into a byte, then
-append that byte to the demo data. Return true if the demo data storage is full,
-otherwise return false.
+append that byte to the demo data. Return true if the demo data could not be
+written, otherwise return false.
 */
 bbool WriteDemoFrame(void)
 {
-    if (demoDataLength > 4998) return true;
-
     /*
     This function runs early enough in the game loop that this assignment
     doesn't change the behavior of any player/actor touch.
     */
     winLevel = isKeyDown[SCANCODE_X];
 
-    *(miscData + demoDataPos) = cmdWest | (cmdEast  << 1) | (cmdNorth << 2) |
-        (cmdSouth << 3) | (cmdJump  << 4) | (cmdBomb  << 5) | (winLevel << 6);
+    return PutDemoFrame(cmdWest | (cmdEast  << 1) | (cmdNorth << 2) |
+        (cmdSouth << 3) | (cmdJump  << 4) | (cmdBomb  << 5) | (winLevel << 6));
+}
+
+/*
+Create the named demo file and write a placeholder header, ready for recording.
+*/
+void CreateDemoData(char *filename)
+{
+    word version = DEMO_VERSION;
 
-    demoDataPos++;
-    demoDataLength++;
+    demoFp = fopen(filename, "wb");
+    demoFrameCount = 0;
+    demoBufferPos = 0;
+    demoRunLength = 0;
 
-    return false;
+    if (demoFp == NULL) return;
+
+    fwrite(DEMO_MAGIC, 1, 4, demoFp);
+    fwrite(&version, 2, 1, demoFp);
+    fwrite(&demoFrameCount, 4, 1, demoFp);
 }
 
 /*
-Flush the recorded demo data to disk.
+Flush the recorded demo data to disk, fill in the frame count in the header,
+and close the demo file.
 */
 void SaveDemoData(void)
 {
-    FILE *fp = fopen("PREVDEMO.MNI", "wb");
-    miscDataContents = IMAGE_DEMO;
+    if (demoFp == NULL) return;
+
+    if (demoRunLength != 0) {
+        PutDemoByte(DEMO_RUN_FLAG | (demoRunLength - 1));
+    }
 
-    putw(demoDataLength, fp);
-    fwrite(miscData, demoDataLength, 1, fp);
+    fwrite(demoBuffer, 1, demoBufferPos, demoFp);
 
-    fclose(fp);
+    fseek(demoFp, 4 + 2, SEEK_SET);  /* skip magic and version */
+    fwrite(&demoFrameCount, 4, 1, demoFp);
+
+    fclose(demoFp);
+    demoFp = NULL;
 }
 
 /*
-Read demo data into memory.
+Begin playback of the demo data in the passed file, which must be positioned at
+the start of the data. The file is read from as the demo plays, and closed by
+CloseDemoData(). Both the original format and version 2 are understood. A null
+file plays as an empty demo.
 */
-void LoadDemoData(void)
+void LoadDemoData(FILE *fp)
 {
-    FILE *fp = GroupEntryFp("PREVDEMO.MNI");
-    miscDataContents = IMAGE_DEMO;
+    char magic[4];
 
-    if (fp == NULL) {
-        /* These were already set in InitializeGame() */
-        demoDataLength = 0;
-        demoDataPos = 0;
+    demoFp = fp;
+    demoFrameCount = demoFramePos = 0;
+    demoBadCheckpoint = DEMO_NO_DIVERGENCE;
+    demoBufferPos = demoBufferLength = 0;
+    demoRunLength = 0;
+
+    if (demoFp == NULL) return;
+
+    fread(magic, 1, 4, demoFp);
+
+    if (memcmp(magic, DEMO_MAGIC, 4) == 0) {
+        fread(&demoVersion, 2, 1, demoFp);
+        fread(&demoFrameCount, 4, 1, demoFp);
     } else {
-        demoDataLength = getw(fp);
-        fread(miscData, demoDataLength, 1, fp);
+        /* Original format; the first word is the frame count */
+        demoVersion = 1;
+        demoFrameCount = *(word *)magic;
+        fseek(demoFp, -2, SEEK_CUR);
     }
-
-    fclose(fp);
 }
 
 /*
-Read the state of the keyboard/joystick for the next iteration of the game loop.
+Close the demo file after playback.
+*/
+void CloseDemoData(void)
+{
+    if (demoFp == NULL) return;
 
-Returns a status byte that indicates if the game should end or if a level change
-is needed.
+    fclose(demoFp);
+    demoFp = NULL;
+}
+
+/*
+Write a keyframe for the current frame of demo playback to the passed file: the
+position of the demo reader, followed by the world as WriteWorldState() writes
+it and a WORLD_STATE_END marker.
 */
-byte ProcessGameInput(byte demostate)
+void WriteDemoKeyframe(FILE *fp, word *pristine)
 {
-    if (demostate != DEMOSTATE_PLAY) {
-        if (
-            isKeyDown[SCANCODE_TAB] &&
-            isKeyDown[SCANCODE_F12] &&
+    DemoKeyframe key;
+    word end[2];
+    long start = ftell(fp);
+
+    key.frame = demoFramePos;
+    key.demooffset = ftell(demoFp) - (demoBufferLength - demoBufferPos);
+    key.framesleft = demoFrameCount;
+    key.lastinput = demoLastInput;
+    key.runlength = demoRunLength;
+    key.levelnum = levelNum;
+    key.hash = HashWorldState(CRC16_INITIAL);
+    key.numdeltas = 0;
+    key.crc = CRC16_INITIAL;
+
+    /* Placeholder; rewritten with the delta count and CRC once they're known */
+    fwrite(&key, sizeof(key), 1, fp);
+
+    key.numdeltas = WriteWorldState(fp, pristine, &key.crc);
+    key.crc = UpdateCRC16(key.crc, &key, sizeof(key) - sizeof(key.crc));
+
+    fseek(fp, start, SEEK_SET);
+    fwrite(&key, sizeof(key), 1, fp);
+    fseek(fp, 0, SEEK_END);
+
+    end[0] = WORLD_STATE_END;
+    end[1] = 0;
+    fwrite(end, 2, 2, fp);
+}
+
+/*
+Play the demo in the passed file headless from the beginning to the end, taking
+a keyframe every `interval` frames (and one before the first frame), and write
+them all into a new keyframe file with the given name. The demo file is left
+open for playback; use SeekDemo() to go anywhere in it. Returns false if the
+keyframe file could not be written.
+*/
+bool BuildDemoKeyframes(FILE *demo, char *key_name, word interval)
+{
+    DemoKeyHeader header;
+    FILE *fp;
+    word *pristine;
+    dword *index;
+    bbool washeadless = isHeadless;
+    bool wassoundenabled = isSoundEnabled;
+    bool ok;
+
+    pristine = malloc(WORLD_SAVE_CHUNK);
+    index = malloc(DEMO_KEY_MAX * sizeof(dword));
+    fp = fopen(key_name, "wb");
+
+    if (pristine == NULL || index == NULL || fp == NULL) {
+        if (fp != NULL) fclose(fp);
+        free(pristine);
+        free(index);
+
+        return false;
+    }
+
+    memcpy(header.magic, DEMO_KEY_MAGIC, 4);
+    header.version = DEMO_KEY_VERSION;
+    header.worldsize = sizeof(World);
+    header.codestamp = FP_OFF((void far *)ProcessActor);
+    header.interval = interval;
+    header.count = 0;
+    header.demolength = filelength(fileno(demo));
+    header.index = 0;
+
+    /* Placeholder; rewritten with the keyframe count and index offset at the end */
+    fwrite(&header, sizeof(header), 1, fp);
+
+    isHeadless = true;
+    isSoundEnabled = false;
+
+    ResetWorld();
+    InitializeGame();
+    demoState = DEMOSTATE_PLAY;
+    SwitchLevel(levelNum);
+    LoadMaskedTileData("MASKTILE.MNI");
+    LoadDemoData(demo);
+
+    do {
+        if (demoFramePos % interval == 0 && header.count < DEMO_KEY_MAX) {
+            index[header.count++] = ftell(fp);
+            WriteDemoKeyframe(fp, pristine);
+        }
+    } while (StepGame(DEMOSTATE_PLAY) == GAME_STEP_CONTINUE);
+
+    isHeadless = washeadless;
+    isSoundEnabled = wassoundenabled;
+
+    header.index = ftell(fp);
+    fwrite(index, sizeof(dword), header.count, fp);
+
+    fseek(fp, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, fp);
+
+    ok = !ferror(fp);
+    fclose(fp);
+    free(pristine);
+    free(index);
+
+    if (!ok) remove(key_name);
+
+    return ok;
+}
+
+/*
+Open a keyframe file written by BuildDemoKeyframes() for use by SeekDemo().
+Returns false if the file doesn't exist, was written by a different build of the
+game, or was taken from a demo file of a different length than `demo_length`.
+*/
+bool OpenDemoKeyframes(char *key_name, dword demo_length)
+{
+    FILE *fp = fopen(key_name, "rb");
+
+    if (fp == NULL) return false;
+
+    if (
+        fread(&demoKeyHeader, sizeof(demoKeyHeader), 1, fp) != 1 ||
+        memcmp(demoKeyHeader.magic, DEMO_KEY_MAGIC, 4) != 0 ||
+        demoKeyHeader.version != DEMO_KEY_VERSION ||
+        demoKeyHeader.worldsize != sizeof(World) ||
+        demoKeyHeader.codestamp != FP_OFF((void far *)ProcessActor) ||
+        demoKeyHeader.demolength != demo_length ||
+        demoKeyHeader.count == 0 ||
+        (demoKeyIndex = malloc(demoKeyHeader.count * sizeof(dword))) == NULL
+    ) {
+        fclose(fp);
+
+        return false;
+    }
+
+    fseek(fp, demoKeyHeader.index, SEEK_SET);
+    fread(demoKeyIndex, sizeof(dword), demoKeyHeader.count, fp);
+
+    demoKeyFp = fp;
+
+    return true;
+}
+
+/*
+Close the keyframe file opened by OpenDemoKeyframes().
+*/
+void CloseDemoKeyframes(void)
+{
+    if (demoKeyFp == NULL) return;
+
+    fclose(demoKeyFp);
+    free(demoKeyIndex);
+    demoKeyFp = NULL;
+}
+
+/*
+Move demo playback to the passed frame number. The world and the demo reader are
+restored from the nearest keyframe at or before that frame, and the frames in
+between are run headless. Both the demo and its keyframe file must be open.
+Returns false if the keyframe fails its CRC, or if the restored world doesn't
+hash the same as it did when the keyframe was taken; playback can't go on from
+there in either case.
+*/
+bool SeekDemo(dword frame)
+{
+    DemoKeyframe key;
+    bbool washeadless = isHeadless;
+    bool wassoundenabled = isSoundEnabled;
+    dword k = frame / demoKeyHeader.interval;
+    dword remaining;
+    byte *buffer;
+    word length;
+    word crc = CRC16_INITIAL;
+
+    if (demoFp == NULL || demoKeyFp == NULL) return false;
+
+    if (k >= demoKeyHeader.count) k = demoKeyHeader.count - 1;
+
+    fseek(demoKeyFp, demoKeyIndex[(word)k], SEEK_SET);
+    if (fread(&key, sizeof(key), 1, demoKeyFp) != 1) return false;
+
+    buffer = malloc(WORLD_SAVE_CHUNK);
+    if (buffer == NULL) return false;
+
+    remaining = SAVE_RECORD_SIZE + sizeof(World) + 4 + (dword)key.numdeltas * 4;
+    while (remaining != 0) {
+        length = remaining < WORLD_SAVE_CHUNK ? (word)remaining : WORLD_SAVE_CHUNK;
+        if (fread(buffer, 1, length, demoKeyFp) != length) break;
+
+        crc = UpdateCRC16(crc, buffer, length);
+        remaining -= length;
+    }
+
+    free(buffer);
+
+    crc = UpdateCRC16(crc, &key, sizeof(key) - sizeof(key.crc));
+    if (remaining != 0 || crc != key.crc) return false;
+
+    fseek(demoKeyFp, demoKeyIndex[(word)k] + sizeof(key), SEEK_SET);
+
+    fseek(demoFp, key.demooffset, SEEK_SET);
+    demoBufferPos = demoBufferLength = 0;
+    demoFramePos = key.frame;
+    demoFrameCount = key.framesleft;
+    demoLastInput = key.lastinput;
+    demoRunLength = key.runlength;
+
+    worldStateFp = demoKeyFp;
+    SwitchLevel(key.levelnum);
+    worldStateFp = NULL;
+
+    if (HashWorldState(CRC16_INITIAL) != key.hash) return false;
+
+    isHeadless = true;
+    isSoundEnabled = false;
+
+    while (demoFramePos < frame) {
+        if (StepGame(DEMOSTATE_PLAY) != GAME_STEP_CONTINUE) break;
+    }
+
+    isHeadless = washeadless;
+    isSoundEnabled = wassoundenabled;
+
+    /* Nothing was drawn while fast-forwarding, status bar included */
+    ClearGameScreen();
+    InvalidateMapRegion();
+
+    return true;
+}
+
+/*
+Supply the input for one frame of an explorer run (see ExploreInputs()), with
+the same movement and action lockouts that apply to keyboard input. When the
+explorer is committing to a move, the input is also appended to the demo data.
+*/
+byte ReadExploreFrame(void)
+{
+    byte input = exploreInput;
+
+    if (blockMovementCmds) input &= ~(0x01 | 0x02 | 0x10);
+    if (blockActionCmds) input &= ~(0x04 | 0x08 | 0x20);
+
+    UnpackDemoInput(input);
+
+    if (isExploreRecording && PutDemoFrame(input)) return GAME_INPUT_QUIT;
+
+    /* Any key stops the explorer */
+    if ((inportb(0x0060) & 0x80) == 0) return GAME_INPUT_QUIT;
+
+    return GAME_INPUT_CONTINUE;
+}
+
+/*
+Read the state of the keyboard/joystick for the next iteration of the game loop.
+
+Returns a status byte that indicates if the game should end or if a level change
+is needed.
+*/
+byte ProcessGameInput(byte demostate)
+{
+    if (demostate == DEMOSTATE_EXPLORE) return ReadExploreFrame();
+
+    if (demostate != DEMOSTATE_PLAY) {
+        if (
+            isKeyDown[SCANCODE_TAB] &&
+            isKeyDown[SCANCODE_F12] &&
             isKeyDown[SCANCODE_KP_DOT]  /* Del */
         ) {
             isDebugMode = !isDebugMode;
@@ -9772,115 +11028,297 @@ void NextLevel(void)
 }
 
 /*
-Run the game loop. This function does not return until the entire game has been
-won or the player quits.
+Return the level number that NextLevel() would most likely move to if the
+current level were won right now, without showing anything or changing any
+state. The prediction for the last level of a section depends on the current
+star count, which can still change before the level is actually won.
 */
-void GameLoop(byte demostate)
+word PredictNextLevel(void)
 {
-    for (;;) {
-        word result;
+    word stars = (word)gameStars;
+
+    if (demoState != DEMOSTATE_NONE) {
+        switch (levelNum) {
+        case 0:
+            return 13;
+        case 13:
+            return 5;
+        case 5:
+            return 9;
+        case 9:
+            return 16;
+        }
+    } else {
+        switch (levelNum) {
+        case 2:
+        case 6:
+        case 10:
+        case 14:
+        case 18:
+        case 22:
+        case 26:
+            return levelNum + 2;
+        case 3:
+        case 7:
+        case 11:
+        case 15:
+        case 19:
+        case 23:
+        case 27:
+        case 0:
+        case 4:
+        case 8:
+        case 12:
+        case 16:
+        case 20:
+        case 24:
+            return levelNum + 1;
+        case 1:
+        case 5:
+        case 9:
+        case 13:
+        case 17:
+        case 21:
+        case 25:
+            if (stars > 49) return levelNum + 2;
+            if (stars > 24) return levelNum + 1;
+            return levelNum + 3;
+        }
+    }
 
-        while (gameTickCount < 13)
-            ;  /* VOID */
+    return levelNum;
+}
 
-        gameTickCount = 0;
+/*
+Spend a little of the idle time at the end of a frame reading ahead the group
+entries that the next level is expected to need. First the map flags word is
+staged, then (once the flags are known) the backdrop image and music, but only
+if they're going to differ from what is loaded now. Each call reads at most one
+chunk from the disk.
 
-        AnimatePalette();
+Everything staged here is only ever used as a read cache by the group entry
+loaders, so a wrong prediction costs nothing except the time spent reading.
+lastGroupEntryLength is left as the game's own last load set it.
+*/
+void PrefetchNextLevel(void)
+{
+    word nextlevel = PredictNextLevel();
+    word flags;
+    GroupView view;
+    GroupEntry *music;
+    dword lastlength;
 
-        result = ProcessGameInputHelper(activePage, demostate);
-        if (result == GAME_INPUT_QUIT) return;
-        if (result == GAME_INPUT_RESTART) continue;
+    if (nextlevel == levelNum || nextlevel >= sizeof(mapNames) / sizeof(mapNames[0])) return;
 
-        MovePlayer();
+    if (nextlevel != prefetchLevelNum) {
+        ClearPrefetch();
+        prefetchLevelNum = nextlevel;
 
-        if (scooterMounted != 0) {
-            MovePlayerScooter();
-        }
+        /* If the flags can't be staged, don't go reading them from the disk. */
+        isPrefetchFlagsKnown = !QueuePrefetch(mapNames[nextlevel], 2);
+    }
 
-        if (queuePlayerDizzy || playerDizzyLeft != 0) {
-            ProcessPlayerDizzy();
-        }
+    if (!StepPrefetch() || isPrefetchFlagsKnown) return;
+
+    isPrefetchFlagsKnown = true;
+
+    /* This is served from the prefetch buffer, not the disk. */
+    lastlength = lastGroupEntryLength;
+    GroupEntryView(mapNames[nextlevel], &view);
+    ReadGroupView(&view, &flags, 2);
+    CloseGroupView(&view);
+    lastGroupEntryLength = lastlength;
 
-        MovePlatforms();
-        MoveFountains();
-        DrawMapRegion();
+    if (
+        (flags & 0x00df) != (mapFlags & 0x00df) &&
+        !HasCookedAsset(COOKED_BACKDROP(flags & 0x001f, BDVARIANT_BASE)) &&
+        !HasBackdropCache(COOKED_BACKDROP(flags & 0x001f, BDVARIANT_BASE))
+    ) {
+        QueuePrefetch(backdropNames[flags & 0x001f], 0x5a00);
+    }
 
-        if (DrawPlayerHelper()) continue;
+    /* Not GroupEntryLength(), which would disturb lastGroupEntryLength */
+    music = FindGroupEntry(musicNames[(flags >> 11) & 0x001f]);
+    if (isAdLibPresent && (flags >> 11) != (mapFlags >> 11) && music != NULL) {
+        QueuePrefetch(musicNames[(flags >> 11) & 0x001f], (word)music->length);
+    }
+}
 
-        DrawFountains();
-        MoveAndDrawActors();
-        MoveAndDrawShards();
-        MoveAndDrawSpawners();
-        DrawRandomEffects();
-        DrawExplosions();
-        MoveAndDrawDecorations();
-        DrawLights();
+#ifdef BENCHMARK
+static dword benchFrames, benchTicks;
+static word benchLevel = WORD_MAX;
+#endif  /* BENCHMARK */
 
-        if (demoState != DEMOSTATE_NONE) {
-            DrawSprite(SPR_DEMO_OVERLAY, 0, 18, 4, DRAWMODE_ABSOLUTE);
-        }
+/*
+Run one frame of gameplay: read input, move everything in the world, and draw
+the result onto the draw page before flipping it into view. Returns one of the
+GAME_STEP_* values to say whether the game should go on.
+
+Frame pacing is the caller's job. With `isHeadless` set, nothing is drawn or
+flipped, but every bit of game logic (including the logic that lives inside the
+various Draw* functions) runs exactly as it would otherwise.
+*/
+byte StepGame(byte demostate)
+{
+    word result;
+
+    AnimatePalette();
+
+    result = ProcessGameInputHelper(activePage, demostate);
+    if (result == GAME_INPUT_QUIT) return GAME_STEP_QUIT;
+    if (result == GAME_INPUT_RESTART) return GAME_STEP_CONTINUE;
+
+    MovePlayer();
+
+    if (scooterMounted != 0) {
+        MovePlayerScooter();
+    }
+
+    if (queuePlayerDizzy || playerDizzyLeft != 0) {
+        ProcessPlayerDizzy();
+    }
+
+    MovePlatforms();
+    MoveFountains();
+    DrawMapRegion();
+
+    if (DrawPlayerHelper()) return GAME_STEP_CONTINUE;
+
+    DrawFountains();
+    MoveAndDrawActors();
+    MoveAndDrawShards();
+    MoveAndDrawSpawners();
+    DrawRandomEffects();
+    DrawExplosions();
+    MoveAndDrawDecorations();
+    DrawLights();
+
+    if (demoState != DEMOSTATE_NONE) {
+        DrawSprite(SPR_DEMO_OVERLAY, 0, 18, 4, DRAWMODE_ABSOLUTE);
+    }
 
 #ifdef DEBUG_BAR
-        {
-            char debugBar[41];
-            word x, y;
-
-            /* Dump variable contents into a bar at the edges of the screen. */
-            for (x = 0; x < 40; x++) {
-                DrawSpriteTile(fontTileData + FONT_BACKGROUND_GRAY, x, 0);
-                for (y = 19; y < 25; y++) {
-                    DrawSpriteTile(fontTileData + FONT_BACKGROUND_GRAY, x, y);
-                }
-            }
+    {
+        char debugBar[41];
+        word x, y;
 
-            sprintf(debugBar,
-                "E%uL%02u! PX=%03u PY=%03u SX=%03u SY=%03u",
-                EPISODE, levelNum, playerX, playerY, scrollX, scrollY);
-            DrawTextLine(0, 0, debugBar);
-            sprintf(debugBar,
-                "Score=%07lu Health=%u:%u Bomb=%u Star=%02lu",
-                gameScore, playerHealth - 1, playerMaxHealth, playerBombs, gameStars);
-            DrawTextLine(0, 19, debugBar);
-            sprintf(debugBar,
-                "CJ=%d CJL=%d iF=%d FT=%02d iR=%u iLJ=%u MN=%02u",
-                cmdJump, cmdJumpLatch, isPlayerFalling, playerFallTime,
-                isPlayerRecoiling, isPlayerLongJumping, playerMomentumNorth);
-            DrawTextLine(0, 20, debugBar);
-            sprintf(debugBar,
-                "JT=%d QD=%u DL=%u DT=%02u FDT=%02d HC=%02u",
-                playerJumpTime, queuePlayerDizzy, playerDizzyLeft, playerDeadTime,
-                playerFallDeadTime, playerHurtCooldown);
-            DrawTextLine(0, 21, debugBar);
-            TestPlayerMove(1, playerX, playerY + 1);
-            sprintf(debugBar,
-                "NSWE=%u%u%u%u PS=%u iSE=%u iSW=%u cC=%03u CD=%u",
-                TestPlayerMove(DIR4_NORTH, playerX, playerY - 1),
-                TestPlayerMove(DIR4_SOUTH, playerX, playerY + 1),
-                TestPlayerMove(DIR4_WEST, playerX - 1, playerY),
-                TestPlayerMove(DIR4_EAST, playerX + 1, playerY),
-                pounceStreak, isPlayerSlidingEast, isPlayerSlidingWest,
-                canPlayerCling, playerClingDir);
-            DrawTextLine(0, 22, debugBar);
-        }
+        /* Dump variable contents into a bar at the edges of the screen. */
+        for (x = 0; x < 40; x++) {
+            DrawSpriteTile(fontTileData + FONT_BACKGROUND_GRAY, x, 0);
+            for (y = 19; y < 25; y++) {
+                DrawSpriteTile(fontTileData + FONT_BACKGROUND_GRAY, x, y);
+            }
+        }
+
+        sprintf(debugBar,
+            "E%uL%02u! PX=%03u PY=%03u SX=%03u SY=%03u",
+            EPISODE, levelNum, playerX, playerY, scrollX, scrollY);
+        DrawTextLine(0, 0, debugBar);
+        sprintf(debugBar,
+            "Score=%07lu Health=%u:%u Bomb=%u Star=%02lu",
+            gameScore, playerHealth - 1, playerMaxHealth, playerBombs, gameStars);
+        DrawTextLine(0, 19, debugBar);
+        sprintf(debugBar,
+            "CJ=%d CJL=%d iF=%d FT=%02d iR=%u iLJ=%u MN=%02u",
+            cmdJump, cmdJumpLatch, isPlayerFalling, playerFallTime,
+            isPlayerRecoiling, isPlayerLongJumping, playerMomentumNorth);
+        DrawTextLine(0, 20, debugBar);
+        sprintf(debugBar,
+            "JT=%d QD=%u DL=%u DT=%02u FDT=%02d HC=%02u",
+            playerJumpTime, queuePlayerDizzy, playerDizzyLeft, playerDeadTime,
+            playerFallDeadTime, playerHurtCooldown);
+        DrawTextLine(0, 21, debugBar);
+        TestPlayerMove(1, playerX, playerY + 1);
+        sprintf(debugBar,
+            "NSWE=%u%u%u%u PS=%u iSE=%u iSW=%u cC=%03u CD=%u",
+            TestPlayerMove(DIR4_NORTH, playerX, playerY - 1),
+            TestPlayerMove(DIR4_SOUTH, playerX, playerY + 1),
+            TestPlayerMove(DIR4_WEST, playerX - 1, playerY),
+            TestPlayerMove(DIR4_EAST, playerX + 1, playerY),
+            pounceStreak, isPlayerSlidingEast, isPlayerSlidingWest,
+            canPlayerCling, playerClingDir);
+        DrawTextLine(0, 22, debugBar);
+    }
 #endif  /* DEBUG_BAR */
 
+#ifdef BENCHMARK
+    if (benchTicks != 0) {
+        char benchBar[41];
+        word x;
+        /* Tenths of a frame per second, with 140 ticks per second */
+        word tenths = (word)((benchFrames * 1400L) / benchTicks);
+
+        for (x = 0; x < 40; x++) {
+            DrawSpriteTile(fontTileData + FONT_BACKGROUND_GRAY, x, 0);
+        }
+
+        sprintf(benchBar, "L%02u A=%03u FR=%06lu FPS=%3u.%u",
+            levelNum, numActors, benchFrames, tenths / 10, tenths % 10);
+        DrawTextLine(0, 0, benchBar);
+    }
+#endif  /* BENCHMARK */
+
+    if (!isHeadless) {
         SelectDrawPage(activePage);
-        activePage = !activePage;
-        SelectActivePage(activePage);
+        SelectActivePage(!activePage);
+    }
+
+    activePage = !activePage;
+
+    if (pounceHintState == POUNCE_HINT_QUEUED) {
+        pounceHintState = POUNCE_HINT_SEEN;
+        ShowPounceHint();
+    }
+
+    if (winLevel) {
+        winLevel = false;
+        StartSound(SND_WIN_LEVEL);
+        NextLevel();
+        SwitchLevel(levelNum);
+    } else if (winGame) {
+        return GAME_STEP_WIN_GAME;
+    }
+
+    return GAME_STEP_CONTINUE;
+}
 
-        if (pounceHintState == POUNCE_HINT_QUEUED) {
-            pounceHintState = POUNCE_HINT_SEEN;
-            ShowPounceHint();
+/*
+Run the game loop. This function does not return until the entire game has been
+won or the player quits.
+
+Each frame is held to at least 13 ticks of the 140 Hz timer, except in headless
+mode, where frames are run back-to-back as fast as the CPU allows.
+*/
+void GameLoop(byte demostate)
+{
+    for (;;) {
+        byte result;
+
+#ifdef BENCHMARK
+        /* No frame cap; just count how many ticks each frame actually took. */
+        if (benchLevel != levelNum) {
+            benchLevel = levelNum;
+            benchFrames = 0;
+            benchTicks = 0;
+        } else {
+            benchFrames++;
+            benchTicks += gameTickCount;
         }
+#else
+        if (!isHeadless) {
+            while (gameTickCount < PREFETCH_TICK_LIMIT)
+                PrefetchNextLevel();
 
-        if (winLevel) {
-            winLevel = false;
-            StartSound(SND_WIN_LEVEL);
-            NextLevel();
-            SwitchLevel(levelNum);
-        } else if (winGame) {
-            break;
+            while (gameTickCount < 13)
+                ;  /* VOID */
         }
+#endif  /* BENCHMARK */
+
+        gameTickCount = 0;
+
+        result = StepGame(demostate);
+        if (result == GAME_STEP_QUIT) return;
+        if (result == GAME_STEP_WIN_GAME) break;
     }
 
     ShowEnding();
@@ -9959,6 +11397,22 @@ void NewMapActor(word index, word map_actor, int x, int y)
     }
 }
 
+/*
+Fill the map attribute layer and the collision planes from the tile attributes
+of every map cell, so collision tests can read them without looking at the tile
+values first. Must be done after both the map data and the tile attributes are
+loaded; after that, SetMapTile() keeps everything in sync.
+*/
+void BuildMapAttributes(void)
+{
+    word i;
+
+    for (i = 0; i < WORD_MAX / 2; i++) {
+        *(mapAttributeData + i) = TILE_ATTR(*(mapData.w + i));
+        SetCollisionBits(i & (mapWidth - 1), i >> mapYPower, *(mapAttributeData + i));
+    }
+}
+
 /*
 Load data from a map file, initialize global state, and build all actors.
 */
@@ -9967,12 +11421,15 @@ void LoadMapData(word level_num)
     word i;
     word actorwords;
     word a;
-    FILE *fp = GroupEntryFp(mapNames[level_num]);
+    word header[3];  /* flags, width, actor word count */
+    GroupView view;
+
+    GroupEntryView(mapNames[level_num], &view);
 
     isCartoonDataLoaded = false;
 
-    getw(fp);  /* skip over flags */
-    mapWidth = getw(fp);
+    ReadGroupView(&view, header, sizeof(header));
+    mapWidth = header[1];
 
     switch (mapWidth) {
     case 1 << 5:
@@ -9998,15 +11455,16 @@ void LoadMapData(word level_num)
         break;
     }
 
-    actorwords = getw(fp);
+    actorwords = header[2];
     numActors = 0;
+    ClearActorSchedule();
     numPlatforms = 0;
     numFountains = 0;
     numLights = 0;
     areLightsActive = true;
     hasLightSwitch = false;
 
-    fread(mapData.w, actorwords, 2, fp);
+    ReadGroupView(&view, mapData.w, actorwords * 2);
 
     for (i = 0; i < actorwords; i += 3) {
         register word x;
@@ -10020,8 +11478,8 @@ void LoadMapData(word level_num)
         if (numActors > MAX_ACTORS - 1) break;
     }
 
-    fread(mapData.b, WORD_MAX, 1, fp);
-    fclose(fp);
+    ReadGroupView(&view, mapData.b, WORD_MAX);
+    CloseGroupView(&view);
 
     for (i = 0; i < numPlatforms; i++) {
         for (a = 2; a < 7; a++) {
@@ -10032,60 +11490,164 @@ void LoadMapData(word level_num)
 
     levelNum = level_num;
     mapHeight = (word)(0x10000L / (mapWidth * 2)) - (SCROLLH + 1);
+    mapHash = CRC16_INITIAL;
 }
 
 /*
-Track the backdrop parameters (backdrop number and horizontal/vertical scroll
-flags) and return true if they have changed since the last call. Otherwise
-return false.
+Read the map tiles of the specified level into the map data, skipping over the
+actor list without constructing anything. Used when a mid-level save file is
+going to supply the rest of the world.
 */
-bbool IsNewBackdrop(word backdrop)
+void LoadPristineMap(word level_num)
 {
-    static word lastbd = WORD_MAX;
-    static word lasth = WORD_MAX;
-    static word lastv = WORD_MAX;
+    word header[3];  /* flags, width, actor word count */
+    GroupView view;
 
-    if (backdrop != lastbd || hasHScrollBackdrop != lasth || hasVScrollBackdrop != lastv) {
-        lastbd = backdrop;
-        lasth = hasHScrollBackdrop;
-        lastv = hasVScrollBackdrop;
+    GroupEntryView(mapNames[level_num], &view);
 
-        return true;
+    isCartoonDataLoaded = false;
+
+    ReadGroupView(&view, header, sizeof(header));
+    ReadGroupView(&view, mapData.w, header[2] * 2);
+    ReadGroupView(&view, mapData.b, WORD_MAX);
+    CloseGroupView(&view);
+}
+
+/*
+Replace the freshly set up level with the world from a mid-level save file or a
+demo keyframe, reading from the file's current position up to the end of the
+file or a WORLD_STATE_END marker. The map changes recorded in the file are
+applied over the pristine map, and the level's restart record is kept for
+SwitchLevel() to write out. See LoadWorldState() and SeekDemo().
+*/
+void ReadWorldState(FILE *fp)
+{
+    byte *map = mapData.b;
+    byte *attributes = mapAttributeData;
+    word *planes = northPlane;
+    word seg = FP_SEG((void far *)ProcessActor);
+    word delta[2];
+    word i;
+
+    fread(restartRecord, 1, SAVE_RECORD_SIZE, fp);
+    fread(&world, sizeof(World), 1, fp);
+    fread(&paletteStepCount, 4, 1, fp);
+    SetWorldBuffers(map, attributes, planes);
+
+    /* Tick functions are far pointers, and DOS may have put the code elsewhere */
+    for (i = 0; i < numActors; i++) {
+        actors[i].tickfunc = (ActorTickFunction)MK_FP(
+            seg, FP_OFF((void far *)actors[i].tickfunc)
+        );
     }
 
-    return false;
+    /* WORLD_STATE_END is past the end of the map, as is anything else bogus */
+    while (fread(delta, 2, 2, fp) == 2 && delta[0] < WORD_MAX / 2) {
+        *(mapData.w + delta[0]) = delta[1];
+    }
 }
 
 /*
-Load the specified backdrop image data into the video memory. Requires a scratch
-buffer to perform this work.
+Load the specified backdrop image from its group entry, generate the requested
+scrolled variants (a bitmask of 1 << BDVARIANT_*) from it, and copy each of them
+into the video memory. Every variant generated here is also saved in the
+backdrop cache for next time. Requires a scratch buffer to perform this work.
 */
-void LoadBackdropData(char *entry_name, byte *scratch)
+void LoadBackdropData(word backdrop_num, byte *scratch, byte variants)
 {
-    FILE *fp = GroupEntryFp(entry_name);
+    GroupView view;
+
+    GroupEntryView(backdropNames[backdrop_num], &view);
 
     EGA_MODE_DEFAULT();
     EGA_BIT_MASK_DEFAULT();
 
     miscDataContents = IMAGE_NONE;
-    fread(scratch, 0x5a00, 1, fp);
+    ReadGroupView(&view, scratch, 0x5a00);
 
-    CopyTilesToEGA(scratch, 0x1680, 0xa300);
+    if (variants & (1 << BDVARIANT_BASE)) {
+        CopyTilesToEGA(scratch, 0x1680, 0xa300);
+        WriteBackdropCache(COOKED_BACKDROP(backdrop_num, BDVARIANT_BASE), scratch);
+    }
 
-    if (hasHScrollBackdrop) {
+    if (variants & ((1 << BDVARIANT_H) | (1 << BDVARIANT_HV))) {
         ShiftPixelsHorizontally(scratch, scratch + 0x5a00);
+    }
+
+    if (variants & (1 << BDVARIANT_H)) {
         CopyTilesToEGA(scratch + 0x5a00, 0x1680, 0xb980);
+        WriteBackdropCache(COOKED_BACKDROP(backdrop_num, BDVARIANT_H), scratch + 0x5a00);
     }
 
-    if (hasVScrollBackdrop) {
+    if (variants & (1 << BDVARIANT_V)) {
         ShiftPixelsVertically(scratch, miscData + 0x1388, scratch + 0xb400);
         CopyTilesToEGA(miscData + 0x1388, 0x1680, 0xd000);
+        WriteBackdropCache(COOKED_BACKDROP(backdrop_num, BDVARIANT_V), miscData + 0x1388);
+    }
 
+    if (variants & (1 << BDVARIANT_HV)) {
         ShiftPixelsVertically(scratch + 0x5a00, miscData + 0x1388, scratch + 0xb400);
         CopyTilesToEGA(miscData + 0x1388, 0x1680, 0xe680);
+        WriteBackdropCache(COOKED_BACKDROP(backdrop_num, BDVARIANT_HV), miscData + 0x1388);
     }
 
-    fclose(fp);
+    CloseGroupView(&view);
+}
+
+/*
+Make sure the video memory holds the specified backdrop image, along with the
+scrolled variants the current level's scroll flags call for.
+
+The video memory acts as a one-backdrop cache: variants that are already there
+from a previous level are left alone. Anything else is read (already split into
+planes) from the cooked asset bundle or the backdrop cache if possible, and only
+generated from the original image as a last resort. Requires a scratch buffer.
+*/
+void LoadBackdrop(word backdrop_num, byte *scratch)
+{
+    static word egaoffsets[] = {0xa300, 0xb980, 0xd000, 0xe680};
+    static word residentbd = WORD_MAX;
+    static byte residentvariants;
+    byte wanted = 1 << BDVARIANT_BASE;
+    word variant, asset;
+
+    if (hasHScrollBackdrop) wanted |= 1 << BDVARIANT_H;
+    if (hasVScrollBackdrop) wanted |= 1 << BDVARIANT_V;
+    if (hasHScrollBackdrop && hasVScrollBackdrop) wanted |= 1 << BDVARIANT_HV;
+
+    if (backdrop_num != residentbd) {
+        residentbd = backdrop_num;
+        residentvariants = 0;
+    }
+
+    EGA_MODE_DEFAULT();
+    EGA_BIT_MASK_DEFAULT();
+
+    for (variant = BDVARIANT_BASE; variant <= BDVARIANT_HV; variant++) {
+        if (!(wanted & (1 << variant))) continue;
+
+        asset = COOKED_BACKDROP(backdrop_num, variant);
+
+        if (
+            (residentvariants & (1 << variant)) ||
+            ReadCookedAsset(asset, scratch, 0x5a00) ||
+            ReadBackdropCache(asset, scratch, 0x5a00)
+        ) {
+            if (!(residentvariants & (1 << variant))) {
+                CopyPlanesToEGA(scratch, 0x1680, egaoffsets[variant]);
+                residentvariants |= 1 << variant;
+            }
+
+            backdropCacheHits++;
+        } else {
+            backdropCacheMisses++;
+        }
+    }
+
+    if ((residentvariants & wanted) != wanted) {
+        LoadBackdropData(backdrop_num, scratch, wanted & ~residentvariants);
+        residentvariants |= wanted;
+    }
 }
 
 /*
@@ -10149,7 +11711,7 @@ Switch to a new level and perform all related tasks.
 */
 void SwitchLevel(word level_num)
 {
-    FILE *fp;
+    GroupView view;
     word bdnum;
 
     if (level_num == 0 && isNewGame) {
@@ -10160,9 +11722,9 @@ void SwitchLevel(word level_num)
         FadeOut();
     }
 
-    fp = GroupEntryFp(mapNames[level_num]);
-    mapFlags = getw(fp);
-    fclose(fp);
+    GroupEntryView(mapNames[level_num], &view);
+    ReadGroupView(&view, &mapFlags, 2);
+    CloseGroupView(&view);
 
     StopMusic();
 
@@ -10175,18 +11737,20 @@ void SwitchLevel(word level_num)
 
     InitializePlayer();
 
-    if (IsNewBackdrop(bdnum)) {
-        LoadBackdropData(backdropNames[bdnum], mapData.b);
-    }
+    LoadBackdrop(bdnum, mapData.b);
 
-    LoadMapData(level_num);
+    if (worldStateFp != NULL) {
+        LoadPristineMap(level_num);
+    } else {
+        LoadMapData(level_num);
+    }
 
     if (level_num == 0 && isNewGame) {
         FadeOut();
         isNewGame = false;
     }
 
-    if (demoState == DEMOSTATE_NONE) {
+    if (demoState == DEMOSTATE_NONE && worldStateFp == NULL) {
         switch (level_num) {
         case 0:
         case 1:
@@ -10214,13 +11778,27 @@ void SwitchLevel(word level_num)
     InitializeDecorations();
     ClearPlayerPush();
     InitializeSpawners();
+
+    if (worldStateFp != NULL) {
+        ReadWorldState(worldStateFp);
+    }
+
     ClearGameScreen();
 
     SelectDrawPage(activePage);
     activePage = !activePage;
     SelectActivePage(activePage);
 
-    SaveGameState('T');
+    /* A restored world restarts from where its level began, not from here */
+    if (worldStateFp != NULL) {
+        WriteSaveRecord('T', restartRecord);
+    } else {
+        SaveGameState('T');
+        ReadSaveRecord('T', restartRecord);
+    }
+
+    isRestartStale = false;
+
     StartGameMusic(musicNum);
 
     if (!isAdLibPresent) {
@@ -10229,6 +11807,8 @@ void SwitchLevel(word level_num)
         LoadTileAttributeData("TILEATTR.MNI");
     }
 
+    BuildMapAttributes();
+
     FadeIn();
 
 #ifdef EXPLOSION_PALETTE
@@ -10238,6 +11818,26 @@ void SwitchLevel(word level_num)
 #endif  /* EXPLOSION_PALETTE */
 }
 
+/*
+Put the world back the way it is at program startup: all zeroes, except for a
+few fields that can't be, and the map buffers, which are kept. Anything that
+replays a game from its start does this first so the result doesn't depend on
+what ran before it.
+*/
+void ResetWorld(void)
+{
+    byte *map = mapData.b;
+    byte *attributes = mapAttributeData;
+    word *planes = northPlane;
+
+    memset(&world, 0, sizeof(World));
+    SetWorldBuffers(map, attributes, planes);
+
+    playerBaseFrame = PLAYER_BASE_WEST;
+    playerFrame = PLAYER_WALK_1;
+    randSeed = RAND_SEED_INITIAL;
+}
+
 /*
 Set all variables that pertain to the state of the game. These are set once at
 the beginning of the game and retain their values across levels.
@@ -10250,13 +11850,556 @@ void InitializeGame(void)
     levelNum = 0;
     playerBombs = 0;
     gameStars = 0;
-    demoDataPos = 0;
-    demoDataLength = 0;
+    demoFrameCount = 0;
     usedCheatCode = false;
     sawBombHint = false;
     sawHealthHint = false;
 }
 
+/*
+Fold everything about the world that decides how the game plays out into the
+running hash `crc`: the player and game state (including the random number step
+counter), every live actor, every other object array, and the record of map
+changes kept in mapHash. Heap pointers and actor tick functions are left out,
+since those differ from one build of the program to the next.
+*/
+word HashWorldState(word crc)
+{
+    return HashWorldStateWith(crc, UpdateCRC16);
+}
+
+/*
+Like HashWorldState(), but fold the world into the running checksum `sum` with
+the passed checksum function instead of the CRC.
+*/
+word HashWorldStateWith(word sum, ChecksumFunction update)
+{
+    word i;
+
+    sum = update(sum, &world, (byte *)&mapData - (byte *)&world);
+    sum = update(sum, &numActors, (byte *)actors - (byte *)&numActors);
+
+    for (i = 0; i < numActors; i++) {
+        sum = update(sum, actors + i, (byte *)&actors[i].tickfunc - (byte *)(actors + i));
+        sum = update(sum, &actors[i].acrophile, (byte *)(actors + i + 1) - (byte *)&actors[i].acrophile);
+    }
+
+    return update(sum, shards, (byte *)(&world + 1) - (byte *)shards);
+}
+
+/*
+Leave one of the headless modes with the passed error message, since falling
+through to the title loop would wait forever for a key nobody will press.
+*/
+void ExitHeadless(char *message)
+{
+    RestoreTextMode();
+
+    fprintf(stderr, "%s\n", message);
+
+    exit(EXIT_FAILURE);
+}
+
+/*
+Play each of the `count` demo files in `names` from start to finish as fast as
+possible, without drawing anything or waiting for the timer, and check the world
+against a golden hash file after every frame. Each demo starts from a freshly
+reset world, so its hashes don't depend on the demos before it. The golden file
+for a demo has the same name with an .HSH extension and holds one word per
+frame; if there is no golden file yet, one is written. A demo that fails one of
+its own embedded checkpoints stops right there, and gets no golden file. A
+report is printed once the screen is back in text mode, and the program exits
+with a failure status if any demo diverged, couldn't be opened, or needed a
+golden file that couldn't be written.
+*/
+void VerifyDemos(int count, char *names[])
+{
+    char drive[MAXDRIVE], dir[MAXDIR], file[MAXFILE], ext[MAXEXT];
+    char hashname[MAXPATH];
+    dword *frames, *divergent;
+    FILE *golden, *demo;
+    word hash, expected;
+    bbool iscreating;
+    byte result;
+    int i, failures = 0;
+
+    frames = malloc(count * sizeof(dword));
+    divergent = malloc(count * sizeof(dword));
+    if (frames == NULL || divergent == NULL) ExitHeadless("Not enough memory");
+
+    isHeadless = true;
+    isSoundEnabled = false;
+    isMusicEnabled = false;
+
+    for (i = 0; i < count; i++) {
+        frames[i] = 0;
+
+        demo = fopen(names[i], "rb");
+        if (demo == NULL) {
+            divergent[i] = DEMO_NOT_FOUND;
+            continue;
+        }
+
+        fnsplit(names[i], drive, dir, file, ext);
+        fnmerge(hashname, drive, dir, file, ".HSH");
+
+        golden = fopen(hashname, "rb");
+        iscreating = (golden == NULL);
+        if (iscreating) {
+            golden = fopen(hashname, "wb");
+            if (golden == NULL) {
+                fclose(demo);
+                divergent[i] = DEMO_GOLDEN_UNWRITABLE;
+                continue;
+            }
+        }
+
+        ResetWorld();
+        InitializeGame();
+        demoState = DEMOSTATE_PLAY;
+        SwitchLevel(levelNum);
+        LoadMaskedTileData("MASKTILE.MNI");
+        LoadDemoData(demo);
+
+        hash = CRC16_INITIAL;
+        divergent[i] = iscreating ? DEMO_GOLDEN_WRITTEN : DEMO_NO_DIVERGENCE;
+
+        do {
+            result = StepGame(DEMOSTATE_PLAY);
+            if (result == GAME_STEP_QUIT) break;
+
+            hash = HashWorldState(hash);
+
+            if (iscreating) {
+                fwrite(&hash, 2, 1, golden);
+            } else if (
+                divergent[i] == DEMO_NO_DIVERGENCE &&
+                (fread(&expected, 2, 1, golden) != 1 || expected != hash)
+            ) {
+                divergent[i] = frames[i];
+            }
+
+            frames[i]++;
+        } while (result == GAME_STEP_CONTINUE);
+
+        /* A golden file that runs longer than the demo is a divergence too */
+        if (
+            !iscreating && divergent[i] == DEMO_NO_DIVERGENCE &&
+            fread(&expected, 2, 1, golden) == 1
+        ) {
+            divergent[i] = frames[i];
+        }
+
+        /* A checkpoint inside the demo may have caught it first */
+        if (demoBadCheckpoint < divergent[i]) {
+            divergent[i] = demoBadCheckpoint;
+        }
+
+        if (iscreating && ferror(golden) && divergent[i] == DEMO_GOLDEN_WRITTEN) {
+            divergent[i] = DEMO_GOLDEN_UNWRITABLE;
+        }
+
+        CloseDemoData();
+        fclose(golden);
+
+        if (iscreating && divergent[i] != DEMO_GOLDEN_WRITTEN) {
+            remove(hashname);
+        }
+    }
+
+    RestoreTextMode();
+
+    for (i = 0; i < count; i++) {
+        if (divergent[i] == DEMO_NOT_FOUND) {
+            printf("%s: can't open\n", names[i]);
+            failures++;
+        } else if (divergent[i] == DEMO_GOLDEN_UNWRITABLE) {
+            printf("%s: can't write golden hashes\n", names[i]);
+            failures++;
+        } else if (divergent[i] == DEMO_GOLDEN_WRITTEN) {
+            printf("%s: %lu frames, golden hashes written\n", names[i], frames[i]);
+        } else if (divergent[i] != DEMO_NO_DIVERGENCE) {
+            printf("%s: diverged at frame %lu of %lu\n", names[i], divergent[i], frames[i]);
+            failures++;
+        } else {
+            printf("%s: %lu frames OK\n", names[i], frames[i]);
+        }
+    }
+
+    exit(failures != 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+/*
+Play the named demo file visibly, starting at the passed frame number, then
+return to the title loop. The demo's keyframe file (same name, .KEY extension)
+is built first if it doesn't exist or is out of date. Nothing is played if the
+keyframe doesn't restore to the world it was taken from.
+*/
+void PlayDemoFrom(char *demo_name, dword frame)
+{
+    char drive[MAXDRIVE], dir[MAXDIR], file[MAXFILE], ext[MAXEXT];
+    char keyname[MAXPATH];
+    FILE *demo = fopen(demo_name, "rb");
+    dword length;
+
+    if (demo == NULL) return;
+
+    length = filelength(fileno(demo));
+
+    fnsplit(demo_name, drive, dir, file, ext);
+    fnmerge(keyname, drive, dir, file, ".KEY");
+
+    if (
+        !OpenDemoKeyframes(keyname, length) && (
+            !BuildDemoKeyframes(demo, keyname, DEMO_KEY_INTERVAL) ||
+            !OpenDemoKeyframes(keyname, length)
+        )
+    ) {
+        fclose(demo);
+
+        return;
+    }
+
+    InitializeGame();
+    demoState = DEMOSTATE_PLAY;
+    LoadMaskedTileData("MASKTILE.MNI");
+    rewind(demo);
+    LoadDemoData(demo);
+
+    if (SeekDemo(frame)) {
+        isInGame = true;
+        GameLoop(DEMOSTATE_PLAY);
+        isInGame = false;
+    }
+
+    StopMusic();
+    CloseDemoData();
+    CloseDemoKeyframes();
+}
+
+/*
+Inputs the explorer chooses between: standing still, walking, jumping, looking
+up and down, and dropping a bomb. Trying all 64 combinations of the six command
+bits would multiply the search time for little gain, since most are redundant.
+*/
+static byte exploreActions[] = {
+    0x00,         /* idle */
+    0x01, 0x02,   /* west, east */
+    0x10,         /* jump */
+    0x11, 0x12,   /* jump west, jump east */
+    0x04, 0x08,   /* north, south */
+    0x20          /* bomb */
+};
+
+static WorldSnapshot *exploreRoot;
+static dword exploreSet[EXPLORE_SET_SIZE];
+static word exploreOriginX, exploreOriginY, exploreOriginLevel;
+
+/*
+Add the current world state to the explorer's set of states seen during this
+search step. States are keyed on both their CRC and their Fletcher-16 checksum,
+since a 16-bit CRC alone would collide often enough over a search to prune
+states that were never actually seen. Returns false if it was already there (or
+the set is full), meaning the state isn't worth searching from again.
+*/
+bbool AddExploreState(void)
+{
+    dword key;
+    word slot, probes;
+
+    key = (dword)HashWorldState(CRC16_INITIAL) << 16;
+    key |= HashWorldStateWith(0, UpdateFletcher16);
+    if (key == 0) key = 1;  /* zero marks an empty slot */
+
+    slot = (word)(key >> 16) & (EXPLORE_SET_SIZE - 1);
+    for (probes = 0; probes < EXPLORE_SET_SIZE; probes++) {
+        if (exploreSet[slot] == key) return false;
+
+        if (exploreSet[slot] == 0) {
+            exploreSet[slot] = key;
+
+            return true;
+        }
+
+        slot = (slot + 1) & (EXPLORE_SET_SIZE - 1);
+    }
+
+    return false;
+}
+
+/*
+Run the game headless for EXPLORE_HOLD frames with the passed action held down.
+Returns the StepGame() result that ended the run early, or GAME_STEP_CONTINUE.
+*/
+byte RunExploreAction(byte action)
+{
+    word i;
+    byte result;
+
+    exploreInput = exploreActions[action];
+
+    for (i = 0; i < EXPLORE_HOLD; i++) {
+        result = StepGame(DEMOSTATE_EXPLORE);
+
+        if (result == GAME_STEP_QUIT) isExploreAborted = true;
+        if (result != GAME_STEP_CONTINUE) return result;
+    }
+
+    return GAME_STEP_CONTINUE;
+}
+
+/*
+Score the current state by how much progress it represents. Winning the game
+beats everything, then reaching a later level, then staying alive with more
+health, then distance from where the player was when the explorer arrived on
+this level.
+*/
+dword ExploreScore(void)
+{
+    word dx, dy;
+
+    if (winGame) return 0xffffffffUL;
+    if (playerDeadTime != 0 || playerFallDeadTime != 0) return 0;
+    if (levelNum != exploreOriginLevel) return (dword)(levelNum + 1) << 24;
+
+    dx = playerX > exploreOriginX ? playerX - exploreOriginX : exploreOriginX - playerX;
+    dy = playerY > exploreOriginY ? playerY - exploreOriginY : exploreOriginY - playerY;
+
+    return ((dword)playerHealth << 16) + dx + dy;
+}
+
+/*
+Return the best score reachable with `depth` more actions from the state that
+results from restoring the explorer's root snapshot and running the `length`
+actions in `prefix`, and store the first action of the best branch through
+`best_action` if it isn't NULL. Each action is tried in turn, from the root
+every time, since there is only memory for the one snapshot. Branches that lead
+to a state that was already seen are not followed.
+*/
+dword ExploreBranch(byte *prefix, word length, word depth, byte *best_action)
+{
+    dword score, best = 0;
+    word i;
+    byte action, result;
+
+    for (action = 0; action < sizeof(exploreActions); action++) {
+        RestoreWorld(exploreRoot);
+
+        for (i = 0; i < length; i++) {
+            RunExploreAction(prefix[i]);
+        }
+
+        result = RunExploreAction(action);
+        if (isExploreAborted) return best;
+
+        if (!AddExploreState()) continue;
+
+        score = ExploreScore();
+        if (result == GAME_STEP_CONTINUE && depth > 1 && score != 0) {
+            prefix[length] = action;
+            score = ExploreBranch(prefix, length + 1, depth - 1, NULL);
+        }
+
+        if (score > best) {
+            best = score;
+            if (best_action != NULL) *best_action = action;
+        }
+    }
+
+    return best;
+}
+
+/*
+Search for a good sequence of inputs from the start of a new game, one action at
+a time, and record the chosen actions into the named demo file as they are
+committed. Each step looks EXPLORE_DEPTH actions ahead from a snapshot of the
+world, picks the first action of the best branch, and replays it to advance the
+snapshot. Stops after `steps` steps, when the game is won, when no action leads
+anywhere, or when a key is pressed. A report is printed once the screen is back
+in text mode.
+*/
+void ExploreInputs(char *demo_name, word steps)
+{
+    byte prefix[EXPLORE_DEPTH];
+    byte action, result = GAME_STEP_CONTINUE;
+    word step;
+
+    exploreRoot = malloc(sizeof(WorldSnapshot));
+    if (exploreRoot == NULL || !NewWorldSnapshot(exploreRoot)) {
+        ExitHeadless("Not enough memory");
+    }
+
+    isHeadless = true;
+    isSoundEnabled = false;
+    isMusicEnabled = false;
+    isExploreAborted = false;
+
+    /* Set up like demo verification, so the result plays back the same */
+    ResetWorld();
+    InitializeGame();
+    demoState = DEMOSTATE_PLAY;
+    SwitchLevel(levelNum);
+    LoadMaskedTileData("MASKTILE.MNI");
+    CreateDemoData(demo_name);
+
+    exploreOriginLevel = WORD_MAX;
+
+    for (step = 0; step < steps && result == GAME_STEP_CONTINUE; step++) {
+        if (levelNum != exploreOriginLevel) {
+            exploreOriginLevel = levelNum;
+            exploreOriginX = playerX;
+            exploreOriginY = playerY;
+        }
+
+        SnapshotWorld(exploreRoot);
+        memset(exploreSet, 0, sizeof(exploreSet));
+
+        if (ExploreBranch(prefix, 0, EXPLORE_DEPTH, &action) == 0) break;
+        if (isExploreAborted) break;
+
+        RestoreWorld(exploreRoot);
+
+        isExploreRecording = true;
+        result = RunExploreAction(action);
+        isExploreRecording = false;
+    }
+
+    SaveDemoData();
+    FreeWorldSnapshot(exploreRoot);
+    free(exploreRoot);
+
+    RestoreTextMode();
+
+    printf("%s: %u steps, %lu frames, reached level %u%s\n",
+        demo_name, step, demoFrameCount, levelNum,
+        winGame ? " and won" : (isExploreAborted ? " (stopped)" : ""));
+
+    exit(EXIT_SUCCESS);
+}
+
+/*
+Write an observation of the current state to standard output for the step
+server: the StepGame() result, the level number, the player position, the
+scroll position, and the player's health, then the sprite type and position of
+every live actor, then the map cells visible in the game window. All values are
+words; the actor list is preceded by its length.
+*/
+void WriteObservation(byte status)
+{
+    word header[8];
+    word i, count = 0;
+
+    for (i = 0; i < numActors; i++) {
+        if (!actors[i].dead) count++;
+    }
+
+    header[0] = status;
+    header[1] = levelNum;
+    header[2] = playerX;
+    header[3] = playerY;
+    header[4] = scrollX;
+    header[5] = scrollY;
+    header[6] = playerHealth;
+    header[7] = count;
+    fwrite(header, 2, 8, stdout);
+
+    for (i = 0; i < numActors; i++) {
+        if (actors[i].dead) continue;
+
+        fwrite(&actors[i].sprite, 2, 1, stdout);
+        fwrite(&actors[i].x, 2, 1, stdout);
+        fwrite(&actors[i].y, 2, 1, stdout);
+    }
+
+    for (i = 0; i < SCROLLH; i++) {
+        fwrite(MAP_CELL_ADDR(scrollX, scrollY + i), 2, SCROLLW, stdout);
+    }
+
+    fflush(stdout);
+}
+
+/*
+Run the game as a step server for an external program that drives it over
+standard input and output, both of which must be redirected. Each request is a
+command byte followed by its arguments, and every request but SERVE_QUIT is
+answered with an observation (see WriteObservation()):
+
+    SERVE_RESET level       Start the level over from a fresh game, or from a
+                            cached snapshot of that starting state (random
+                            seed and restart save included) if there is one.
+    SERVE_STEP input count  Run `count` frames headless with `input` (the six
+                            command bits of a demo byte) held down. Only valid
+                            after a reset.
+    SERVE_QUIT              Exit.
+
+Pressing any key also ends the server, once the current request is done.
+*/
+void ServeSteps(void)
+{
+    WorldSnapshot *start;
+    word startlevel = WORD_MAX;
+    byte status = GAME_STEP_CONTINUE;
+    int command, level, input, count;
+
+    start = malloc(sizeof(WorldSnapshot));
+    if (start == NULL || !NewWorldSnapshot(start)) {
+        ExitHeadless("Not enough memory");
+    }
+
+    setmode(fileno(stdin), O_BINARY);
+    setmode(fileno(stdout), O_BINARY);
+
+    isHeadless = true;
+    isSoundEnabled = false;
+    isMusicEnabled = false;
+    demoState = DEMOSTATE_PLAY;  /* no level intros or hint popups */
+
+    LoadMaskedTileData("MASKTILE.MNI");
+
+    while ((command = getchar()) != EOF && command != SERVE_QUIT) {
+        if (command == SERVE_RESET) {
+            level = getchar();
+            if (level == EOF || level >= sizeof(mapNames) / sizeof(mapNames[0])) break;
+
+            if (level == startlevel) {
+                RestoreWorld(start);
+            } else {
+                ResetWorld();
+                InitializeGame();
+                SwitchLevel(level);
+                SnapshotWorld(start);
+                startlevel = level;
+            }
+
+            status = GAME_STEP_CONTINUE;
+        } else if (command == SERVE_STEP && startlevel != WORD_MAX) {
+            input = getchar();
+            count = getchar();
+            if (input == EOF || count == EOF) break;
+
+            /* Only the six command bits; the rest would skip levels */
+            exploreInput = input & 0x3f;
+
+            /* A finished game stays finished until it is reset */
+            for (; count > 0 && status == GAME_STEP_CONTINUE; count--) {
+                status = StepGame(DEMOSTATE_EXPLORE);
+            }
+        } else {
+            break;
+        }
+
+        WriteObservation(status);
+        if (status == GAME_STEP_QUIT) break;
+    }
+
+    FreeWorldSnapshot(start);
+    free(start);
+
+    RestoreTextMode();
+
+    exit(EXIT_SUCCESS);
+}
+
 /*
 Main entry point for the game, after the 80286 processor test has passed. This
 function never returns; the only way to end the program is for something within
@@ -10264,7 +12407,12 @@ the loop to call ExitClean() or a similar function to request termination.
 */
 void InnerMain(int argc, char *argv[])
 {
-    if (argc == 2) {
+    bbool isverifying = argc > 2 && stricmp(argv[1], "/VERIFY") == 0;
+    bbool isseeking = argc == 4 && stricmp(argv[1], "/SEEK") == 0;
+    bbool isexploring = argc == 4 && stricmp(argv[1], "/EXPLORE") == 0;
+    bbool isserving = argc == 2 && stricmp(argv[1], "/SERVE") == 0;
+
+    if (argc == 2 && !isserving) {
         writePath = argv[1];
     } else {
         writePath = "\0";
@@ -10272,14 +12420,30 @@ void InnerMain(int argc, char *argv[])
 
     Startup();
 
+    if (isverifying) {
+        VerifyDemos(argc - 2, argv + 2);
+    } else if (isseeking) {
+        PlayDemoFrom(argv[2], atol(argv[3]));
+    } else if (isexploring) {
+        ExploreInputs(argv[2], atoi(argv[3]));
+    } else if (isserving) {
+        ServeSteps();
+    }
+
     for (;;) {
         demoState = TitleLoop();
 
-        SwitchLevel(levelNum);
+        if (isLevelResumed) {
+            isLevelResumed = false;  /* LoadWorldState() already set it up */
+        } else {
+            SwitchLevel(levelNum);
+        }
         LoadMaskedTileData("MASKTILE.MNI");
 
         if (demoState == DEMOSTATE_PLAY) {
-            LoadDemoData();
+            LoadDemoData(GroupEntryFp("PREVDEMO.MNI"));
+        } else if (demoState == DEMOSTATE_RECORD) {
+            CreateDemoData("PREVDEMO.MNI");
         }
 
         isInGame = true;
@@ -10294,6 +12458,8 @@ void InnerMain(int argc, char *argv[])
 
         if (demoState == DEMOSTATE_RECORD) {
             SaveDemoData();
+        } else if (demoState == DEMOSTATE_PLAY) {
+            CloseDemoData();
         }
     }
 }
@@ -121,6 +121,44 @@ static int joystickBandLeft[3], joystickBandRight[3];
 static int joystickBandTop[3], joystickBandBottom[3];
 static bool joystickBtn1Bombs;
 
+/*
+In-memory copy of the STN and VOL group file directories. Every entry found in
+either header gets a slot in `groupEntries`, and `groupHashTable` maps a hashed
+entry name to the slot that GroupEntryFp() should use for it.
+*/
+static GroupEntry groupEntries[GROUP_MAX_ENTRIES];
+static byte groupHashTable[GROUP_HASH_SIZE];
+static word numGroupEntries;
+
+/*
+DOS file handle for whichever group file GroupEntryView() touched last. It stays
+open for as long as consecutive reads keep coming from the same group file.
+*/
+static int groupHandle = -1;
+static byte groupHandleGroup;
+
+/*
+DOS file handles for the cooked asset bundle and the backdrop cache, or -1 if
+there isn't a usable one.
+*/
+static int cookedHandle = -1;
+static int backdropCacheHandle = -1;
+
+/*
+Group entry prefetch state. Each slot stages the leading bytes of one group
+entry into `prefetchBuffer`, a little at a time. Views of an entry that has a
+slot are served from memory for as far as the slot has been staged.
+*/
+static PrefetchSlot prefetchSlots[PREFETCH_SLOTS];
+static byte *prefetchBuffer;
+static word prefetchBufferSize, prefetchBufferUsed, numPrefetchSlots;
+
+/*
+Lookup table for UpdateCRC16(), filled in on first use.
+*/
+static word crcTable[256];
+static bool isCRCTableReady = false;
+
 /*
 Junk variables. Some are read/written, others are padding, none are important.
 The ones declared non-static are to avoid "never used" warnings.
@@ -640,6 +678,8 @@ void WaitHard(word delay)
 {
     gameTickCount = 0;
 
+    if (isHeadless) return;
+
     while (gameTickCount < delay)
         ;  /* VOID */
 }
@@ -657,6 +697,8 @@ void WaitSoft(word delay)
 {
     gameTickCount = 0;
 
+    if (isHeadless) return;
+
     do {
         if (gameTickCount >= delay) break;
     } while ((inportb(0x0060) & 0x80) != 0);
@@ -794,6 +836,7 @@ void ClearScreen(void)
 {
     word x, y;
 
+    InvalidateMapRegion();
     EGA_MODE_LATCHED_WRITE();
 
     for (y = 0; y < 25 * 320; y += 320) {
@@ -946,6 +989,7 @@ word DrawTextFrame(
 ) {
     register int x, y;
 
+    InvalidateMapRegion();
     EGA_MODE_LATCHED_WRITE();
 
     /* Draw background, implicitly erasing anything behind the frame */
@@ -1193,6 +1237,8 @@ void DrawStatusBarScore(dword add_points, word x, word y)
 {
     gameScore += add_points;
 
+    if (isHeadless) return;
+
 #ifdef DEBUG_BAR
     return;
 #endif  /* DEBUG_BAR */
@@ -1221,6 +1267,8 @@ to be passed in.
 */
 void DrawStatusBarStars(word x, word y)
 {
+    if (isHeadless) return;
+
 #ifdef DEBUG_BAR
     return;
 #endif  /* DEBUG_BAR */
@@ -1249,6 +1297,8 @@ to be passed in.
 */
 void DrawStatusBarBombs(word x, word y)
 {
+    if (isHeadless) return;
+
 #ifdef DEBUG_BAR
     return;
 #endif  /* DEBUG_BAR */
@@ -1289,6 +1339,8 @@ void DrawStatusBarHealth(word x, word y)
 {
     word bar;
 
+    if (isHeadless) return;
+
 #ifdef DEBUG_BAR
     return;
 #endif  /* DEBUG_BAR */
@@ -1421,6 +1473,119 @@ void CheckHighScore(void)
     ShowHighScoreTable();
 }
 
+/*
+Hash the first 11 characters of a group entry name (or fewer, if the name is
+shorter than that) into a groupHashTable slot number. Only 11 characters are
+considered because that's all the entry name comparisons have ever looked at.
+*/
+word HashGroupEntryName(char *name)
+{
+    register word hash = 0;
+    register int i;
+
+    for (i = 0; i < 11 && *(name + i) != '\0'; i++) {
+        hash = (hash << 3) + hash + (byte)*(name + i);
+    }
+
+    return hash & (GROUP_HASH_SIZE - 1);
+}
+
+/*
+Read the header of one group file and add each of its entries to the group
+directory. An entry that has the same name as one that is already in the
+directory replaces it.
+*/
+void LoadGroupHeader(char *filename, byte group)
+{
+    byte header[GROUP_HEADER_SIZE];
+    FILE *fp = fopen(filename, "rb");
+    GroupEntry *entry;
+    word slot;
+    int i;
+
+    if (fp == NULL) return;
+
+    memset(header, 0, GROUP_HEADER_SIZE);
+    fread(header, 1, GROUP_HEADER_SIZE, fp);
+    fclose(fp);
+
+    for (i = 0; i < GROUP_HEADER_SIZE; i += GROUP_ENTRY_SIZE) {
+        if (header[i] == '\0') break;  /* no more entries */
+
+        entry = groupEntries + numGroupEntries;
+        memcpy(entry->name, header + i, 12);
+        entry->group = group;
+        entry->offset = *(dword *)(header + i + 12);
+        entry->length = *(dword *)(header + i + 16);
+
+        slot = HashGroupEntryName(entry->name);
+        while (
+            groupHashTable[slot] != GROUP_HASH_EMPTY &&
+            strncmp(groupEntries[groupHashTable[slot]].name, entry->name, 11) != 0
+        ) {
+            slot = (slot + 1) & (GROUP_HASH_SIZE - 1);
+        }
+
+        groupHashTable[slot] = (byte)numGroupEntries++;
+    }
+}
+
+/*
+Build the in-memory group directory from the STN and VOL file headers. This
+only needs to happen once, before the first call to GroupEntryFp().
+
+The VOL file is read first so that any STN entries with the same name take its
+place, and later entries in a header replace earlier ones. Both rules preserve
+the lookup order of the linear header scan this directory replaced.
+*/
+void LoadGroupDirectory(void)
+{
+    word i;
+
+    for (i = 0; i < GROUP_HASH_SIZE; i++) {
+        groupHashTable[i] = GROUP_HASH_EMPTY;
+    }
+
+    numGroupEntries = 0;
+
+    LoadGroupHeader(volGroupFilename, GROUP_VOL);
+    LoadGroupHeader(stnGroupFilename, GROUP_STN);
+}
+
+/*
+Look up the passed group entry name in the group directory. Returns a pointer to
+the entry's directory slot, or NULL if neither the STN nor the VOL file contains
+an entry by that name.
+
+NOTE: This uses a 20-byte buffer and an 11-byte comparison on a file format
+whose entry names are each 12 bytes long. Fun ensues.
+*/
+GroupEntry *FindGroupEntry(char *entry_name)
+{
+    char name[20];
+    GroupEntry *entry;
+    word slot;
+    int i;
+
+    /* Make an uppercased copy of the entry name as recklessly as possible */
+    for (i = 0; i < 19; i++) {
+        name[i] = *(entry_name + i);
+    }
+    name[19] = '\0';
+    strupr(name);
+
+    slot = HashGroupEntryName(name);
+    while (groupHashTable[slot] != GROUP_HASH_EMPTY) {
+        entry = groupEntries + groupHashTable[slot];
+
+        if (strncmp(entry->name, name, 11) == 0) return entry;
+
+        slot = (slot + 1) & (GROUP_HASH_SIZE - 1);
+    }
+
+    return NULL;
+}
+
 /*
 Return a file pointer matching the passed group entry name and update
 lastGroupEntryLength with the size of the entry's data. This function tries, in
@@ -1429,88 +1594,487 @@ working directory with a name matching the passed entry name. If nothing is
 found, assuming the program doesn't crash due to performing a bunch of
 operations on a null pointer, return NULL.
 
-NOTE: This uses a 20-byte buffer and an 11-byte comparison on a file format
-whose entry names are each 12 bytes long. Fun ensues.
+The first two possibilities are answered by the group directory, so the only
+file that gets opened is the one that holds the data.
 
 NOTE: The STN/VOL format is not formally specified anywhere, so it's not clear
 if the offsets/lengths read from it are supposed to be interpreted as signed or
-unsigned. This function uses a bit of a mismash of the two.
+unsigned. This function treats both of them as unsigned.
 */
 FILE *GroupEntryFp(char *entry_name)
 {
-    byte header[1000];
-    char name[20];
+    GroupEntry *entry = FindGroupEntry(entry_name);
     FILE *fp;
-    dword offset;
     int i;
-    bool found;
 
-    /* Make an uppercased copy of the entry name as recklessly as possible */
-    for (i = 0; i < 19; i++) {
-        name[i] = *(entry_name + i);
+    if (entry == NULL) {
+        /*
+        Attempt to read from the current working directory
+        */
+        fp = fopen(entry_name, "rb");
+        i = fileno(fp);
+        lastGroupEntryLength = filelength(i);
+
+        return fp;
     }
-    name[19] = '\0';
-    strupr(name);
 
-    /*
-    Attempt to read from the STN file
-    */
-    fp = fopen(stnGroupFilename, "rb");
-    found = false;
-    fread(header, 1, 960, fp);
+    fp = fopen(entry->group == GROUP_STN ? stnGroupFilename : volGroupFilename, "rb");
+    lastGroupEntryLength = entry->length;
 
-    /* Final iteration, if reached, will cause a read out of bounds */
-    for (i = 0; i < 980; i += 20) {
-        if (header[i] == '\0') break;  /* no more entries */
+    /* `offset` points to the first byte of the entry's data */
+    fseek(fp, entry->offset, SEEK_SET);
 
-        if (strncmp(header + i, name, 11) == 0) {
-            offset = i + 12;
-            found = true;
-        }
+    return fp;
+}
+
+/*
+Return the DOS file handle for the requested group file, opening it (and closing
+the other one) if it isn't the group file that was used most recently.
+*/
+int OpenGroupHandle(byte group)
+{
+    if (groupHandle == -1 || groupHandleGroup != group) {
+        if (groupHandle != -1) _close(groupHandle);
+
+        groupHandle = _open(group == GROUP_STN ? stnGroupFilename : volGroupFilename, O_RDONLY);
+        groupHandleGroup = group;
     }
 
-    if (!found) {
-        fclose(fp);
+    return groupHandle;
+}
 
+/*
+Prepare a view of the passed group entry's data, positioned at its first byte,
+and update lastGroupEntryLength with the size of the entry's data. Returns true
+if the entry was found, either in a group file or in the current working
+directory, and false otherwise.
+
+Unlike GroupEntryFp(), this keeps the group file open between calls and its
+reads go directly from DOS into the destination buffer without passing through
+a stdio buffer first. Only one view should be read from at a time, since views
+into the same group file share a single file position.
+
+If the entry has been prefetched, reads are served from memory for as many bytes
+as have been staged.
+*/
+bool GroupEntryView(char *entry_name, GroupView *view)
+{
+    GroupEntry *entry = FindGroupEntry(entry_name);
+    word i;
+
+    view->position = 0;
+    view->slot = NULL;
+
+    if (entry == NULL) {
         /*
-        Attempt to read from the VOL file
+        Attempt to read from the current working directory
         */
-        fp = fopen(volGroupFilename, "rb");
-        fread(header, 1, 960, fp);
+        view->handle = _open(entry_name, O_RDONLY);
+        if (view->handle == -1) return false;
 
-        /* Final iteration, if reached, will cause a read out of bounds */
-        for (i = 0; i < 980; i += 20) {
-            if (header[i] == '\0') break;  /* no more entries */
+        view->offset = 0;
+        view->length = filelength(view->handle);
+    } else {
+        view->handle = OpenGroupHandle(entry->group);
+        view->offset = entry->offset;
+        view->length = entry->length;
 
-            if (strncmp(header + i, name, 11) == 0) {
-                offset = i + 12;
-                found = true;
+        for (i = 0; i < numPrefetchSlots; i++) {
+            if (prefetchSlots[i].entry == entry) {
+                view->slot = prefetchSlots + i;
             }
         }
+    }
 
-        if (!found) {
-            fclose(fp);
+    lseek(view->handle, view->offset, SEEK_SET);
+    lastGroupEntryLength = view->length;
 
-            /*
-            Attempt to read from the current working directory
-            */
-            fp = fopen(entry_name, "rb");
-            i = fileno(fp);
-            lastGroupEntryLength = filelength(i);
+    return true;
+}
+
+/*
+Read the next `length` bytes from a group entry view into `dest`, returning the
+number of bytes actually read. As with fread(), nothing stops a read from
+running past the end of the entry and into whatever follows it.
+*/
+word ReadGroupView(GroupView *view, void *dest, word length)
+{
+    PrefetchSlot *slot = view->slot;
+    word count = 0;
+
+    if (slot != NULL && view->position < slot->staged) {
+        count = slot->staged - (word)view->position;
+        if (count > length) count = length;
+
+        movmem(slot->data + (word)view->position, dest, count);
+        view->position += count;
+
+        if (count == length) return count;
+    }
+
+    if (slot != NULL) {
+        /* Staged reads don't move the file position; put it where it belongs. */
+        lseek(view->handle, view->offset + view->position, SEEK_SET);
+    }
+
+    view->position += length - count;
+
+    return count + _read(view->handle, (byte *)dest + count, length - count);
+}
+
+/*
+Release a group entry view. The shared group file handle is left open for the
+next caller; only files opened from the working directory are closed here.
+*/
+void CloseGroupView(GroupView *view)
+{
+    if (view->handle != groupHandle) {
+        _close(view->handle);
+    }
+}
+
+/*
+Return the DOS modification timestamp of an open file, packed as in struct
+ftime, or zero if there is no file.
+*/
+dword FileTimestamp(int handle)
+{
+    struct ftime stamp;
+
+    if (handle == -1 || getftime(handle, &stamp) != 0) return 0;
+
+    return *(dword *)&stamp;
+}
+
+/*
+Fill in the header that an asset file built from the current group files should
+have.
+*/
+void CurrentAssetHeader(CookedHeader *header)
+{
+    int handle;
+
+    movmem(COOKED_MAGIC, header->magic, 4);
+    header->version = COOKED_VERSION;
+
+    handle = OpenGroupHandle(GROUP_STN);
+    header->stnlength = handle == -1 ? 0 : filelength(handle);
+    header->stntime = FileTimestamp(handle);
 
-            return fp;
+    handle = OpenGroupHandle(GROUP_VOL);
+    header->vollength = handle == -1 ? 0 : filelength(handle);
+    header->voltime = FileTimestamp(handle);
+}
+
+/*
+Open an asset file (the cooked asset bundle or the backdrop cache) with the
+given access mode, and return its DOS file handle. Returns -1 if the file can't
+be opened, if its header doesn't match, or if either group file has changed
+size or modification time since it was written.
+*/
+int OpenAssetFile(char *filename, int access)
+{
+    CookedHeader header, current;
+    int handle = _open(filename, access);
+
+    if (handle == -1) return -1;
+
+    CurrentAssetHeader(&current);
+
+    if (
+        _read(handle, &header, COOKED_HEADER_SIZE) != COOKED_HEADER_SIZE ||
+        memcmp(&header, &current, COOKED_HEADER_SIZE) != 0
+    ) {
+        _close(handle);
+        return -1;
+    }
+
+    return handle;
+}
+
+/*
+Return the file offset of the requested asset in an open asset file, or zero if
+there is no file or it doesn't contain that asset.
+*/
+dword AssetOffset(int handle, word asset)
+{
+    dword offset;
+
+    if (handle == -1 || asset >= NUM_COOKED_ASSETS) return 0;
+
+    lseek(handle, COOKED_HEADER_SIZE + (asset * 4L), SEEK_SET);
+    if (_read(handle, &offset, 4) != 4) return 0;
+
+    return offset;
+}
+
+/*
+Read `length` bytes of plane-major image data for the requested asset from an
+open asset file into `dest`. Returns false (and the contents of `dest` are
+undefined) if the asset isn't available.
+*/
+bool ReadAsset(int handle, word asset, void *dest, word length)
+{
+    dword offset = AssetOffset(handle, asset);
+
+    if (offset == 0) return false;
+
+    lseek(handle, offset, SEEK_SET);
+
+    return _read(handle, dest, length) == length;
+}
+
+/*
+Open the cooked asset bundle that COOK.EXE builds from the group files, and keep
+it open for the rest of the run. The bundle is ignored if it's stale; in that
+case every asset is loaded (and converted) from the group files as usual.
+*/
+void OpenCookedBundle(void)
+{
+    cookedHandle = OpenAssetFile(FILENAME_BASE ".CKD", O_RDONLY);
+}
+
+/*
+Return true if the cooked asset bundle can provide the requested asset.
+*/
+bool HasCookedAsset(word asset)
+{
+    return AssetOffset(cookedHandle, asset) != 0;
+}
+
+/*
+Read the requested asset from the cooked asset bundle. See ReadAsset().
+*/
+bool ReadCookedAsset(word asset, void *dest, word length)
+{
+    return ReadAsset(cookedHandle, asset, dest, length);
+}
+
+/*
+Fold `length` bytes of `data` into a running CRC-16 (CCITT polynomial 0x1021)
+and return the result. Start a new CRC with CRC16_INITIAL.
+*/
+word UpdateCRC16(word crc, void *data, word length)
+{
+    byte *src = data;
+
+    if (!isCRCTableReady) {
+        word i, bit, value;
+
+        for (i = 0; i < 256; i++) {
+            value = i << 8;
+
+            for (bit = 0; bit < 8; bit++) {
+                value = (value & 0x8000) ? (value << 1) ^ 0x1021 : value << 1;
+            }
+
+            crcTable[i] = value;
         }
+
+        isCRCTableReady = true;
+    }
+
+    while (length-- != 0) {
+        crc = (crc << 8) ^ crcTable[(crc >> 8) ^ *(src++)];
     }
 
-    /* Here `offset` points to the entry's header data */
-    fseek(fp, offset, SEEK_SET);
-    fread(&offset, 4, 1, fp);
-    fread(&lastGroupEntryLength, 4, 1, fp);
+    return crc;
+}
 
-    /* Now `offset` points to the first byte of the entry's data */
-    fseek(fp, offset, SEEK_SET);
+/*
+Fold `length` bytes of `data` into a running Fletcher-16 checksum and return the
+result. Start a new one with zero. It has nothing in common with UpdateCRC16(),
+so data that collides under one is unlikely to collide under the other too.
+*/
+word UpdateFletcher16(word sum, void *data, word length)
+{
+    byte *src = data;
+    word lo = sum & 0xff, hi = sum >> 8;
 
-    return fp;
+    while (length-- != 0) {
+        lo += *(src++);
+        if (lo >= 255) lo -= 255;
+
+        hi += lo;
+        if (hi >= 255) hi -= 255;
+    }
+
+    return (hi << 8) | lo;
+}
+
+/*
+Open the backdrop cache file, creating it (or starting it over, if it's stale)
+when necessary. The backdrop cache has the same layout as the cooked asset
+bundle, but it is filled in by the game itself, one backdrop variant at a time,
+as they are generated. If the file can't be created (e.g. the game is running
+from read-only media and no write path was given) the game runs without it.
+*/
+void OpenBackdropCache(char *filename)
+{
+    CookedHeader header;
+    dword offset = 0;
+    word i;
+
+    backdropCacheHandle = OpenAssetFile(filename, O_RDWR);
+    if (backdropCacheHandle != -1) return;
+
+    backdropCacheHandle = _creat(filename, 0);
+    if (backdropCacheHandle == -1) return;
+
+    CurrentAssetHeader(&header);
+    _write(backdropCacheHandle, &header, COOKED_HEADER_SIZE);
+
+    for (i = 0; i < NUM_COOKED_ASSETS; i++) {
+        if (_write(backdropCacheHandle, &offset, 4) != 4) {
+            _close(backdropCacheHandle);
+            backdropCacheHandle = -1;
+            return;
+        }
+    }
+}
+
+/*
+Return true if the backdrop cache can provide the requested asset.
+*/
+bool HasBackdropCache(word asset)
+{
+    return AssetOffset(backdropCacheHandle, asset) != 0;
+}
+
+/*
+Read the requested asset from the backdrop cache. See ReadAsset().
+*/
+bool ReadBackdropCache(word asset, void *dest, word length)
+{
+    return ReadAsset(backdropCacheHandle, asset, dest, length);
+}
+
+/*
+Append a row-planar backdrop image to the backdrop cache, split into planes, and
+record it as the requested asset. If anything can't be written, the cache is
+closed and not used again for the rest of the run.
+*/
+void WriteBackdropCache(word asset, byte *image)
+{
+    byte buf[256];
+    dword offset;
+    word plane, i, j, count;
+
+    if (backdropCacheHandle == -1 || asset >= NUM_COOKED_ASSETS) return;
+
+    offset = lseek(backdropCacheHandle, 0, SEEK_END);
+
+    for (plane = 0; plane < 4; plane++) {
+        for (i = 0; i < 0x1680; i += count) {
+            count = 0x1680 - i < sizeof(buf) ? 0x1680 - i : sizeof(buf);
+
+            for (j = 0; j < count; j++) {
+                buf[j] = *(image + ((i + j) * 4) + plane);
+            }
+
+            if (_write(backdropCacheHandle, buf, count) != count) {
+                _close(backdropCacheHandle);
+                backdropCacheHandle = -1;
+                return;
+            }
+        }
+    }
+
+    lseek(backdropCacheHandle, COOKED_HEADER_SIZE + (asset * 4L), SEEK_SET);
+    _write(backdropCacheHandle, &offset, 4);
+}
+
+/*
+Provide the memory area that group entry prefetching should stage data into. If
+this is never called (or `buffer` is NULL), prefetching is disabled and every
+QueuePrefetch() call fails.
+*/
+void InitializePrefetch(byte *buffer, word size)
+{
+    prefetchBuffer = buffer;
+    prefetchBufferSize = buffer == NULL ? 0 : size;
+
+    ClearPrefetch();
+}
+
+/*
+Forget every prefetched group entry and make the whole buffer available again.
+*/
+void ClearPrefetch(void)
+{
+    numPrefetchSlots = 0;
+    prefetchBufferUsed = 0;
+}
+
+/*
+Reserve space to stage the first `length` bytes of the named group entry. Only
+entries inside a group file can be prefetched. Returns true if the entry was
+queued (or was already queued), and false if there is no room for it.
+
+Nothing is actually read here; that happens during subsequent StepPrefetch()
+calls.
+*/
+bool QueuePrefetch(char *entry_name, word length)
+{
+    GroupEntry *entry = FindGroupEntry(entry_name);
+    PrefetchSlot *slot;
+    word i;
+
+    if (entry == NULL) return false;
+
+    for (i = 0; i < numPrefetchSlots; i++) {
+        if (prefetchSlots[i].entry == entry) return true;
+    }
+
+    if (
+        numPrefetchSlots == PREFETCH_SLOTS ||
+        length > prefetchBufferSize - prefetchBufferUsed
+    ) return false;
+
+    slot = prefetchSlots + numPrefetchSlots++;
+    slot->entry = entry;
+    slot->data = prefetchBuffer + prefetchBufferUsed;
+    slot->length = length;
+    slot->staged = 0;
+
+    prefetchBufferUsed += length;
+
+    return true;
+}
+
+/*
+Stage the next chunk of the first queued group entry that isn't fully staged
+yet. Returns true if everything that was queued has been staged, or false if
+there is more work to do.
+*/
+bool StepPrefetch(void)
+{
+    word i, count, got;
+    int handle;
+
+    for (i = 0; i < numPrefetchSlots; i++) {
+        PrefetchSlot *slot = prefetchSlots + i;
+
+        if (slot->staged == slot->length) continue;
+
+        count = slot->length - slot->staged;
+        if (count > PREFETCH_CHUNK_SIZE) count = PREFETCH_CHUNK_SIZE;
+
+        handle = OpenGroupHandle(slot->entry->group);
+        lseek(handle, slot->entry->offset + slot->staged, SEEK_SET);
+        got = _read(handle, slot->data + slot->staged, count);
+
+        if (got == 0 || got > count) {
+            /* Hit the end of the file (or an error); stop where we are. */
+            slot->length = slot->staged;
+        } else {
+            slot->staged += got;
+        }
+
+        return false;
+    }
+
+    return true;
 }
 
 /*
@@ -1527,18 +2091,18 @@ it into the passed Music pointer.
 */
 Music *LoadMusicData(word music_num, Music *dest)
 {
-    FILE *fp;
+    GroupView view;
     Music *localdest = dest;  /* not clear why this copy is needed */
 
     miscDataContents = IMAGE_NONE;
 
-    fp = GroupEntryFp(musicNames[music_num]);
-    fread(&dest->datahead, 1, (word)lastGroupEntryLength + 2, fp);
-    localdest->length = (word)lastGroupEntryLength;
+    GroupEntryView(musicNames[music_num], &view);
+    ReadGroupView(&view, &dest->datahead, (word)view.length + 2);
+    localdest->length = (word)view.length;
 
     SetMusic(true);
 
-    fclose(fp);
+    CloseGroupView(&view);
 
     return localdest;
 }
@@ -2847,19 +3411,26 @@ Display memory statistics for the game.
 - "Total Actors" is the *peak* number of actor slots that have been used since
   the current level (re)started. This does not decrease when actors die, nor
   does it increase when a new actor occupies a dead actor's slot.
+- "BD Hit/Miss" count the backdrop variants that were needed since
+  startup, split by whether they were already in video memory (or could be read
+  pre-shifted from a file) versus having to be generated from scratch.
 */
 void MemoryUsage(void)
 {
-    word x = UnfoldTextFrame(2, 8, 30, "- Memory Usage -", "Press ANY key.");
+    word x = UnfoldTextFrame(2, 10, 30, "- Memory Usage -", "Press ANY key.");
 
     DrawTextLine(x + 6,  4, "Memory free:");
     DrawTextLine(x + 10, 5, "Take Up:");
     DrawTextLine(x + 1,  6, "Total Map Memory:  65049");
     DrawTextLine(x + 5,  7, "Total Actors:");
+    DrawTextLine(x + 11, 8, "BD Hit:");
+    DrawTextLine(x + 10, 9, "BD Miss:");
     DrawNumberFlushRight(x + 24, 4, totalMemFreeAfter);
     DrawNumberFlushRight(x + 24, 5, totalMemFreeBefore);
     DrawNumberFlushRight(x + 24, 7, numActors);
-    WaitSpinner(x + 27, 8);
+    DrawNumberFlushRight(x + 24, 8, backdropCacheHits);
+    DrawNumberFlushRight(x + 24, 9, backdropCacheMisses);
+    WaitSpinner(x + 27, 10);
 }
 
 /*
@@ -34,10 +34,15 @@
 /* Enable this to add vanity text inside the game */
 /*#define VANITY*/
 
+/* Run the game loop uncapped, showing the average frame rate in the top border */
+/*#define BENCHMARK*/
+
 #include <alloc.h>  /* for coreleft() only */
 #include <conio.h>
+#include <dir.h>  /* for fnsplit()/fnmerge() only */
 #include <dos.h>
-#include <io.h>  /* for filelength() only */
+#include <fcntl.h>  /* for O_RDONLY and O_BINARY only */
+#include <io.h>  /* for filelength() and unbuffered group entry reads */
 #include <mem.h>  /* for movmem() only */
 #include <stdio.h>
 #include <stdlib.h>
@@ -83,27 +88,33 @@ typedef void interrupt (*InterruptFunction)(void);
 typedef char HighScoreName[16];
 typedef void (*ActorTickFunction)(word);
 typedef void (*DrawFunction)(byte *, word, word);
+typedef word (*ChecksumFunction)(word, void *, word);
 
+/*
+Fields that ProcessActor() and the draw/collision code touch for every actor on
+every frame come first; the ones only the actor's own tick function cares about
+follow. The flags are byte-sized to keep the (410-element) array small.
+*/
 typedef struct {
     word sprite;
     word frame;
     word x;
     word y;
-    bool forceactive;
-    bool stayactive;
-    bool acrophile;
-    bool weighted;
+    bbool dead;
+    bbool forceactive;
+    bbool stayactive;
+    bbool weighted;
+    byte fallspeed;
+    byte damagecooldown;
+    ActorTickFunction tickfunc;
+    bbool acrophile;
     word private1;
     word private2;
-    word data1;
+    word data1;  /* data1..data5 must stay contiguous; see UpdateDoors() */
     word data2;
     word data3;
     word data4;
     word data5;
-    bool dead;
-    word fallspeed;
-    byte damagecooldown;
-    ActorTickFunction tickfunc;
 } Actor;
 
 typedef struct {
@@ -122,6 +133,13 @@ typedef struct {
     word y;
 } Explosion;
 
+typedef struct {
+    word x;
+    word y;
+    word width;
+    word height;
+} ExplosionRect;
+
 typedef struct {
     word x;
     word y;
@@ -167,11 +185,328 @@ typedef struct {
     word age;
 } Spawner;
 
+typedef struct {
+    word height;
+    word width;
+    byte *tiles;  /* overlays the record's tile offset/chunk words in place */
+} SpriteFrame;
+
+/*
+Everything that changes while the game is being played and has a say in how it
+plays out: the player, the map, every actor and effect, and the counters that
+drive the game's random numbers. Nothing outside of this may influence what the
+next frame of the simulation does, other than input and the (read-only) assets.
+
+Each field is reachable under its old global variable name through the macros
+that follow, so game code reads the same as before.
+*/
+typedef struct {
+    /* Overarching game control */
+    bool winGame, winLevel;
+    dword gameScore, gameStars;
+
+    /* Player position and game interaction */
+    word playerHealth, playerMaxHealth, playerBombs;
+    word playerX, playerY, scrollX, scrollY;
+    word playerFaceDir, playerBombDir;
+    word playerBaseFrame, playerFrame, playerForceFrame;
+    byte playerClingDir;
+    bool canPlayerCling, isPlayerNearHintGlobe, isPlayerNearTransporter;
+    word playerIdleCount, playerMoveCount;
+    word playerBombCooldown, scooterBombCooldown;
+
+    /*
+    Player one-shots. Each of these controls the "happens only once" behavior of
+    something in the game. Some are reset when a new level is started, others
+    persist for the whole game (and into save files).
+    */
+    bbool sawAutoHintGlobe;
+    bool sawJumpPadBubble, sawMonumentBubble, sawScooterBubble;
+    bool sawTransporterBubble, sawPipeBubble, sawBossBubble;
+    bool sawPusherRobotBubble, sawBearTrapBubble, sawMysteryWallBubble;
+    bool sawTulipLauncherBubble, sawHamburgerBubble, sawHurtBubble;
+    bool usedCheatCode, sawBombHint, sawHealthHint;
+    word pounceHintState;
+
+    /* Step counter for GameRand() */
+    word randStepCount;
+
+    /*
+    Seed of WorldRand(), the stand-in for the C library's rand(), and the state
+    of the lightning effect, which decides whether it gets called at all.
+    */
+    dword randSeed;
+    byte lightningState;
+
+    /* Player pain and death */
+    bbool playerIsInvincible;
+    word playerHurtCooldown, playerDeadTime;
+    byte playerFallDeadTime;
+
+    /*
+    Player speed/movement. These control vertical movement in the form of
+    jumping, pouncing, and falling. Horizontal movement takes the form of east/
+    west sliding for slippery surfaces. There are also variables for involuntary
+    pushes and "dizzy" immobilization.
+    */
+    word playerMomentumNorth, playerMomentumSaved;
+    bool isPlayerLongJumping, isPlayerRecoiling;
+    bool isPlayerSlidingEast, isPlayerSlidingWest;
+    bbool isPlayerFalling;
+    int playerFallTime;
+    byte playerJumpTime;
+    word playerPushDir, playerPushMaxTime, playerPushTime, playerPushSpeed;
+    bbool canCancelPlayerPush;
+    bool isPlayerPushed, stopPlayerPushAtWall;
+    bool queuePlayerDizzy;
+    word playerDizzyLeft;
+
+    /* Player immobilization and jump lockout */
+    bbool blockMovementCmds, cmdJumpLatch;
+    bool blockActionCmds;
+
+    /* Level/map control and global world flags */
+    word levelNum, mapFlags, musicNum;
+    word mapWidth, mapHeight, mapYPower;  /* y power = map width expressed as 2^n. */
+    bool hasLightSwitch, hasRain, hasHScrollBackdrop, hasVScrollBackdrop;
+    bool areForceFieldsActive, areLightsActive, arePlatformsActive;
+    byte paletteAnimationNum;
+    word mapHash;  /* running CRC-16 of every SetMapTile() change; see HashWorldState() */
+
+    /*
+    The map and the layers derived from it. These live on the heap; a World only
+    holds the pointers.
+    */
+    union {byte *b; word *w;} mapData;
+    byte *mapAttributeData;
+    word *northPlane, *southPlane, *westPlane, *eastPlane;
+
+    /* Actor (and similar) counts, and odds and ends for some of the actors */
+    word numActors;
+    word numPlatforms, numFountains, numLights;
+    word numBarrels, numEyePlants, pounceStreak;
+    word mysteryWallTime;
+    word activeTransporter, transporterTimeLeft;
+    word scooterMounted;  /* Acts like bool, except at moment of mount (decrements 4->1) */
+    bool isPounceReady;
+    bbool isPlayerInPipe;
+
+    /* Pass-by-global */
+    word nextActorIndex, nextDrawMode;
+
+    /* Fixed-size object arrays */
+    Platform platforms[MAX_PLATFORMS];
+    Fountain fountains[MAX_FOUNTAINS];
+    Light lights[MAX_LIGHTS];
+    Actor actors[MAX_ACTORS];
+    Shard shards[MAX_SHARDS];
+    word explosions[MAX_EXPLOSIONS][sizeof(Explosion) / sizeof(word)];  /* this one's weird */
+    ExplosionRect explosionRects[MAX_EXPLOSIONS];
+    Spawner spawners[MAX_SPAWNERS];
+    Decoration decorations[MAX_DECORATIONS];
+    /* Holds each decoration's currently displayed frame. Why this isn't in the Decoration struct, who knows. */
+    word decorationFrame[MAX_DECORATIONS];
+
+    /*
+    Never reset, so shard behavior is different for each run through the demo
+    playback.
+    */
+    word shardInclination;
+
+    /*
+    Union of the rectangles of every live explosion; `right` and `bottom` are
+    one past the last column/row covered. Empty (left > right) when there are
+    none.
+    */
+    word explosionBoxLeft, explosionBoxRight, explosionBoxTop, explosionBoxBottom;
+
+    /*
+    Actor scheduling. Only actors with their bit set in awakeActors are
+    processed each frame. Actors that fell asleep off-screen are kept in
+    per-column buckets, linked through dormantNext, until the screen scrolls
+    over them again. The deadActors bits mirror each actor's `dead` flag, so
+    free slots can be found without touching the actors themselves.
+    */
+    byte awakeActors[(MAX_ACTORS + 7) / 8], deadActors[(MAX_ACTORS + 7) / 8];
+    word dormantHead[ACTOR_BUCKETS], dormantNext[MAX_ACTORS];
+    byte dormantBucket[MAX_ACTORS];
+} World;
+
+/*
+A complete copy of a World, taken by SnapshotWorld(). The map and its layers are
+too big to share a segment with the rest, so they get buffers of their own.
+*/
+typedef struct {
+    World world;
+    dword paletteStepCount;
+    byte restart[SAVE_RECORD_SIZE];  /* copy of the temporary save file */
+    byte *map;          /* WORD_MAX bytes */
+    byte *attributes;   /* WORD_MAX / 2 bytes */
+    word *planes;       /* COLLISION_PLANE_SIZE * 4 bytes */
+} WorldSnapshot;
+
+typedef struct {
+    char magic[4];
+    word version;
+    word worldsize;  /* sizeof(World) in the build that wrote the file */
+    word codestamp;  /* code offset of ProcessActor(), which differs by build */
+    word levelnum;
+    word numdeltas;
+    word crc;        /* CRC-16 of everything that follows the header */
+} WorldSaveHeader;
+
+typedef struct {
+    char magic[4];
+    word version;
+    word worldsize;  /* sizeof(World) in the build that wrote the file */
+    word codestamp;  /* code offset of ProcessActor(), which differs by build */
+    word interval;   /* frames between keyframes */
+    word count;
+    dword demolength;  /* length of the demo file the keyframes were taken from */
+    dword index;       /* file offset of the table of keyframe offsets */
+} DemoKeyHeader;
+
+typedef struct {
+    dword frame;       /* demo frames played before this keyframe was taken */
+    dword demooffset;  /* demo file offset of the next unread input byte */
+    dword framesleft;
+    byte lastinput, runlength;
+    word levelnum;
+    word hash;  /* HashWorldState() of the world this keyframe holds */
+    word numdeltas;
+    word crc;   /* covers the world that follows and the fields above */
+} DemoKeyframe;
+
+extern World world;
+
+#define winGame                  (world.winGame)
+#define winLevel                 (world.winLevel)
+#define gameScore                (world.gameScore)
+#define gameStars                (world.gameStars)
+#define playerHealth             (world.playerHealth)
+#define playerMaxHealth          (world.playerMaxHealth)
+#define playerBombs              (world.playerBombs)
+#define playerX                  (world.playerX)
+#define playerY                  (world.playerY)
+#define scrollX                  (world.scrollX)
+#define scrollY                  (world.scrollY)
+#define playerFaceDir            (world.playerFaceDir)
+#define playerBombDir            (world.playerBombDir)
+#define playerBaseFrame          (world.playerBaseFrame)
+#define playerFrame              (world.playerFrame)
+#define playerForceFrame         (world.playerForceFrame)
+#define playerClingDir           (world.playerClingDir)
+#define canPlayerCling           (world.canPlayerCling)
+#define isPlayerNearHintGlobe    (world.isPlayerNearHintGlobe)
+#define isPlayerNearTransporter  (world.isPlayerNearTransporter)
+#define playerIdleCount          (world.playerIdleCount)
+#define playerMoveCount          (world.playerMoveCount)
+#define playerBombCooldown       (world.playerBombCooldown)
+#define scooterBombCooldown      (world.scooterBombCooldown)
+#define sawAutoHintGlobe         (world.sawAutoHintGlobe)
+#define sawJumpPadBubble         (world.sawJumpPadBubble)
+#define sawMonumentBubble        (world.sawMonumentBubble)
+#define sawScooterBubble         (world.sawScooterBubble)
+#define sawTransporterBubble     (world.sawTransporterBubble)
+#define sawPipeBubble            (world.sawPipeBubble)
+#define sawBossBubble            (world.sawBossBubble)
+#define sawPusherRobotBubble     (world.sawPusherRobotBubble)
+#define sawBearTrapBubble        (world.sawBearTrapBubble)
+#define sawMysteryWallBubble     (world.sawMysteryWallBubble)
+#define sawTulipLauncherBubble   (world.sawTulipLauncherBubble)
+#define sawHamburgerBubble       (world.sawHamburgerBubble)
+#define sawHurtBubble            (world.sawHurtBubble)
+#define usedCheatCode            (world.usedCheatCode)
+#define sawBombHint              (world.sawBombHint)
+#define sawHealthHint            (world.sawHealthHint)
+#define pounceHintState          (world.pounceHintState)
+#define randStepCount            (world.randStepCount)
+#define randSeed                 (world.randSeed)
+#define lightningState           (world.lightningState)
+#define playerIsInvincible       (world.playerIsInvincible)
+#define playerHurtCooldown       (world.playerHurtCooldown)
+#define playerDeadTime           (world.playerDeadTime)
+#define playerFallDeadTime       (world.playerFallDeadTime)
+#define playerMomentumNorth      (world.playerMomentumNorth)
+#define playerMomentumSaved      (world.playerMomentumSaved)
+#define isPlayerLongJumping      (world.isPlayerLongJumping)
+#define isPlayerRecoiling        (world.isPlayerRecoiling)
+#define isPlayerSlidingEast      (world.isPlayerSlidingEast)
+#define isPlayerSlidingWest      (world.isPlayerSlidingWest)
+#define isPlayerFalling          (world.isPlayerFalling)
+#define playerFallTime           (world.playerFallTime)
+#define playerJumpTime           (world.playerJumpTime)
+#define playerPushDir            (world.playerPushDir)
+#define playerPushMaxTime        (world.playerPushMaxTime)
+#define playerPushTime           (world.playerPushTime)
+#define playerPushSpeed          (world.playerPushSpeed)
+#define canCancelPlayerPush      (world.canCancelPlayerPush)
+#define isPlayerPushed           (world.isPlayerPushed)
+#define stopPlayerPushAtWall     (world.stopPlayerPushAtWall)
+#define queuePlayerDizzy         (world.queuePlayerDizzy)
+#define playerDizzyLeft          (world.playerDizzyLeft)
+#define blockMovementCmds        (world.blockMovementCmds)
+#define cmdJumpLatch             (world.cmdJumpLatch)
+#define blockActionCmds          (world.blockActionCmds)
+#define levelNum                 (world.levelNum)
+#define mapFlags                 (world.mapFlags)
+#define musicNum                 (world.musicNum)
+#define mapWidth                 (world.mapWidth)
+#define mapHeight                (world.mapHeight)
+#define mapYPower                (world.mapYPower)
+#define hasLightSwitch           (world.hasLightSwitch)
+#define hasRain                  (world.hasRain)
+#define hasHScrollBackdrop       (world.hasHScrollBackdrop)
+#define hasVScrollBackdrop       (world.hasVScrollBackdrop)
+#define areForceFieldsActive     (world.areForceFieldsActive)
+#define areLightsActive          (world.areLightsActive)
+#define arePlatformsActive       (world.arePlatformsActive)
+#define paletteAnimationNum      (world.paletteAnimationNum)
+#define mapHash                  (world.mapHash)
+#define mapData                  (world.mapData)
+#define mapAttributeData         (world.mapAttributeData)
+#define northPlane               (world.northPlane)
+#define southPlane               (world.southPlane)
+#define westPlane                (world.westPlane)
+#define eastPlane                (world.eastPlane)
+#define numActors                (world.numActors)
+#define numPlatforms             (world.numPlatforms)
+#define numFountains             (world.numFountains)
+#define numLights                (world.numLights)
+#define numBarrels               (world.numBarrels)
+#define numEyePlants             (world.numEyePlants)
+#define pounceStreak             (world.pounceStreak)
+#define mysteryWallTime          (world.mysteryWallTime)
+#define activeTransporter        (world.activeTransporter)
+#define transporterTimeLeft      (world.transporterTimeLeft)
+#define scooterMounted           (world.scooterMounted)
+#define isPounceReady            (world.isPounceReady)
+#define isPlayerInPipe           (world.isPlayerInPipe)
+#define nextActorIndex           (world.nextActorIndex)
+#define nextDrawMode             (world.nextDrawMode)
+#define platforms                (world.platforms)
+#define fountains                (world.fountains)
+#define lights                   (world.lights)
+#define actors                   (world.actors)
+#define shards                   (world.shards)
+#define explosions               (world.explosions)
+#define explosionRects           (world.explosionRects)
+#define spawners                 (world.spawners)
+#define decorations              (world.decorations)
+#define decorationFrame          (world.decorationFrame)
+#define shardInclination         (world.shardInclination)
+#define explosionBoxLeft         (world.explosionBoxLeft)
+#define explosionBoxRight        (world.explosionBoxRight)
+#define explosionBoxTop          (world.explosionBoxTop)
+#define explosionBoxBottom       (world.explosionBoxBottom)
+#define awakeActors              (world.awakeActors)
+#define deadActors               (world.deadActors)
+#define dormantHead              (world.dormantHead)
+#define dormantNext              (world.dormantNext)
+#define dormantBucket            (world.dormantBucket)
+
 extern bbool isInGame;
-extern bool winGame;
-extern dword gameScore, gameStars;
 extern word miscDataContents;
-extern word playerHealth, playerMaxHealth, playerBombs;
 extern byte demoState;
 extern word activePage;
 extern word gameTickCount;
@@ -179,6 +514,7 @@ extern bool isGodMode;
 extern char *stnGroupFilename, *volGroupFilename;
 extern char *musicNames[];
 extern dword totalMemFreeBefore, totalMemFreeAfter;
+extern word backdropCacheHits, backdropCacheMisses;
 extern HighScoreName highScoreNames[];
 extern dword highScoreValues[];
 extern byte *fontTileData, *maskedTileData, *miscData;
@@ -190,13 +526,25 @@ extern bbool cmdWest, cmdEast, cmdNorth, cmdSouth, cmdJump, cmdBomb;
 extern bool isMusicEnabled, isSoundEnabled;
 extern byte scancodeWest, scancodeEast, scancodeNorth, scancodeSouth, scancodeJump, scancodeBomb;
 extern Music *activeMusic;
-extern word numActors;
+extern bbool isHeadless;
 
 void DrawTextLine(word x_origin, word y_origin, char *text);
 void DrawFullscreenImage(word image_num);
+void InvalidateMapRegion(void);
 void StartSound(word sound_num);
 void PCSpeakerService(void);
 void ShowStarBonus(void);
+byte StepGame(byte demostate);
+word HashWorldState(word crc);
+word HashWorldStateWith(word sum, ChecksumFunction update);
+bbool SaveWorldState(char slot_char);
+bbool LoadWorldState(char slot_char);
+void ReadSaveRecord(char slot_char, byte *record);
+void WriteSaveRecord(char slot_char, byte *record);
+bool NewWorldSnapshot(WorldSnapshot *snap);
+void FreeWorldSnapshot(WorldSnapshot *snap);
+void SnapshotWorld(WorldSnapshot *snap);
+void RestoreWorld(WorldSnapshot *snap);
 void InnerMain(int argc, char *argv[]);
 
 /*****************************************************************************
@@ -205,6 +553,37 @@ void InnerMain(int argc, char *argv[]);
 
 typedef char KeyName[6];
 
+typedef struct {
+    char name[12];  /* not necessarily null-terminated */
+    byte group;
+    dword offset;
+    dword length;
+} GroupEntry;
+
+typedef struct {
+    GroupEntry *entry;
+    byte *data;
+    word length;
+    word staged;
+} PrefetchSlot;
+
+typedef struct {
+    int handle;
+    dword offset;
+    dword length;
+    dword position;
+    PrefetchSlot *slot;
+} GroupView;
+
+typedef struct {
+    char magic[4];
+    word version;
+    dword stnlength;
+    dword vollength;
+    dword stntime;  /* struct ftime, packed */
+    dword voltime;
+} CookedHeader;
+
 typedef struct {
     word junk;  /* in IDLIBC.C/ControlJoystick(), this is movement direction */
     bool button1;
@@ -234,7 +613,26 @@ void UpdateBombs(void);
 void UpdateHealth(void);
 void ShowHighScoreTable(void);
 void CheckHighScore(void);
+void LoadGroupDirectory(void);
+GroupEntry *FindGroupEntry(char *entry_name);
 FILE *GroupEntryFp(char *entry_name);
+int OpenGroupHandle(byte group);
+bool GroupEntryView(char *entry_name, GroupView *view);
+word ReadGroupView(GroupView *view, void *dest, word length);
+void CloseGroupView(GroupView *view);
+void OpenCookedBundle(void);
+bool HasCookedAsset(word asset);
+bool ReadCookedAsset(word asset, void *dest, word length);
+word UpdateCRC16(word crc, void *data, word length);
+word UpdateFletcher16(word sum, void *data, word length);
+void OpenBackdropCache(char *filename);
+bool HasBackdropCache(word asset);
+bool ReadBackdropCache(word asset, void *dest, word length);
+void WriteBackdropCache(word asset, byte *image);
+void InitializePrefetch(byte *buffer, word size);
+void ClearPrefetch(void);
+bool QueuePrefetch(char *entry_name, word length);
+bool StepPrefetch(void);
 void ShowOrderingInformation(void);
 void ShowStory(void);
 void StartGameMusic(word music_num);
@@ -106,3 +106,16 @@ how their tile attributes make them behave:
 #define TILE_DARK_GRAY          0x3e78
 /* First masked tile value. */
 #define TILE_MASKED_0           0x3e80  /* aka 16,000 */
+
+/*
+Tile attribute bits, as stored in TILEATTR.MNI (one byte for each tile) and in
+the per-level map attribute layer.
+*/
+#define TILEATTR_BLOCK_SOUTH    0x01
+#define TILEATTR_BLOCK_NORTH    0x02
+#define TILEATTR_BLOCK_WEST     0x04
+#define TILEATTR_BLOCK_EAST     0x08
+#define TILEATTR_SLIPPERY       0x10
+#define TILEATTR_IN_FRONT       0x20
+#define TILEATTR_SLOPED         0x40
+#define TILEATTR_CAN_CLING      0x80
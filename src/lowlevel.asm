@@ -379,6 +379,89 @@ ENDM
         ret
 ENDP
 
+;
+; Copy a horizontal run of 8x8 pixel tiles from one location on the current
+; draw page to another location on the same page.
+;
+; This procedure moves map tiles that are already on the screen when the game
+; scrolls, so they don't need to be redrawn from the tile storage area one at a
+; time. Each of the eight pixel rows in the run is copied with a single string
+; move. Like DrawSolidTile, all four color planes are copied in parallel through
+; the EGA's internal latches, so the EGA *must* be in latched write mode.
+;
+; The source and destination areas may overlap. Each pixel row is copied in
+; whichever direction leaves the source data intact until it has been read. If
+; the source and destination are on different tile rows, the caller is
+; responsible for copying the tile rows in a safe order.
+;
+; src_offset (word): Memory offset of the leftmost source tile, relative to the
+;     current draw page segment.
+; dst_offset (word): Memory offset of the leftmost destination tile, relative
+;     to the current draw page segment.
+; count (word): Number of tiles in the run. Must be at least 1.
+; Returns: Nothing
+; Registers destroyed: AX, BX, CX, DX, ES
+;
+PROC _CopyScreenTiles FAR @@src_offset:WORD, @@dst_offset:WORD, @@count:WORD
+        PUBLIC _CopyScreenTiles
+        push  bp
+        mov   bp,sp
+        push  ds
+        push  si
+        push  di
+
+        ; Both the source and destination are on the draw page:
+        ;   DS:SI <- Source tile address (in EGA memory)
+        ;   ES:DI <- Destination tile address (in EGA memory)
+        mov   dx,[drawPageSegment]
+        mov   es,dx
+        mov   ds,dx
+        ASSUME ds:NOTHING
+        mov   si,[@@src_offset]
+        mov   di,[@@dst_offset]
+        mov   bx,[@@count]
+
+        ; AX holds the distance from where one row's string move leaves SI/DI to
+        ; where the next row's should begin. Copying forward, the move ends just
+        ; right of the run; copying backward, it ends just left of it.
+        mov   ax,SCREEN_Y_STRIDE
+        cmp   si,di
+        jae   @@forward
+
+        ; Destination is right of (or below) the source. Copy each row from its
+        ; rightmost byte, moving left.
+        add   si,bx
+        dec   si
+        add   di,bx
+        dec   di
+        add   ax,bx
+        std
+        jmp   SHORT @@copy
+
+@@forward:
+        sub   ax,bx
+
+@@copy:
+        mov   dx,8
+
+@@do_row:
+        mov   cx,bx
+        rep movsb
+        add   si,ax
+        add   di,ax
+        dec   dx
+        jnz   @@do_row
+
+        cld
+
+        pop   di
+        pop   si
+        pop   ds
+        ASSUME ds:DGROUP
+        pop   bp
+        ret
+ENDP
+
 ;
 ; Recalculate the drawPageSegment address from the current drawPageNumber.
 ;
@@ -28,25 +28,33 @@ CPU types as returned by GetProcessorType().
 #define CPUTYPE_80286           6
 #define CPUTYPE_80386           7
 
+/*
+EGA access primitives for C code. All direct port and video memory accesses go
+through these.
+*/
+#define EGA_OUTPORT(port, value)    outport(port, value)
+#define EGA_POKE(offset, value)     { *((byte *)MK_FP(0xa000, offset)) = (value); }
+#define EGA_MOVMEM(src, offset, len) movmem(src, MK_FP(0xa000, offset), len)
+
 /*
 Resets the EGA's bit mask to its default state. Allows writes to all eight pixel
 positions in each written byte.
 */
-#define EGA_BIT_MASK_DEFAULT() { outport(0x03ce, (0xff << 8) | 0x08); }
+#define EGA_BIT_MASK_DEFAULT() { EGA_OUTPORT(0x03ce, (0xff << 8) | 0x08); }
 
 /*
 Resets the EGA's read and write modes to their default state. This allows for
 direct (i.e. non-latched) writes from the CPU.
 */
-#define EGA_MODE_DEFAULT() { outport(0x03ce, (0x00 << 8) | 0x05); }
+#define EGA_MODE_DEFAULT() { EGA_OUTPORT(0x03ce, (0x00 << 8) | 0x05); }
 
 /*
 Resets the EGA's map mask to its default state (allows writes to all four memory
 planes), sets default read mode, and enables latched writes from the CPU.
 */
 #define EGA_MODE_LATCHED_WRITE() { \
-    outport(0x03c4, (0x0f << 8) | 0x02);  /* map mask: all planes active */ \
-    outport(0x03ce, (0x01 << 8) | 0x05);  /* mode: default w/ latched write */ \
+    EGA_OUTPORT(0x03c4, (0x0f << 8) | 0x02);  /* map mask: all planes active */ \
+    EGA_OUTPORT(0x03ce, (0x01 << 8) | 0x05);  /* mode: default w/ latched write */ \
 }
 
 /*
@@ -80,6 +88,7 @@ void SetVideoMode(word mode_num);
 void SetBorderColorRegister(word color_value);
 void SetPaletteRegister(word palette_index, word color_value);
 void DrawSolidTile(word src_offset, word dst_offset);
+void CopyScreenTiles(word src_offset, word dst_offset, word count);
 void SelectDrawPage(word page_num);
 void DrawSpriteTileTranslucent(byte *src, word x, word y);
 void LightenScreenTileWest(word x, word y);